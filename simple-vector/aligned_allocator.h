@@ -0,0 +1,59 @@
+#pragma once
+
+#include <cstdint>
+#include <new>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Распределитель с выравниванием буфера на Alignment байт через выровненный operator new,
+// например на кэш-линию или ширину регистра AVX-512 (64 байта), чтобы векторные
+// циклы обходились без невыровненных загрузок и пролога.
+// С PadTail = true массив дополняется созданными элементами до кратного Alignment числа байт:
+// за последним элементом вектора до границы Alignment всегда лежит доступная память,
+// и цикл может обработать хвост целым регистром без скалярного остатка.
+// Хвост изначально заполнен значениями по умолчанию, но после PopBack или Resize
+// в нём могут остаться прежние значения
+template <size_t Alignment = 64, bool PadTail = false>
+struct AlignedAllocator {
+    static_assert(Alignment != 0 && (Alignment & (Alignment - 1)) == 0, "Alignment must be a power of two");
+
+    static constexpr size_t ALIGNMENT = Alignment;
+
+    // Количество элементов, которое действительно создаётся для массива из size элементов
+    template <typename Type>
+    static constexpr size_t PaddedSize(size_t size) noexcept {
+        if constexpr (PadTail) {
+            const size_t bytes = (size * sizeof(Type) + Alignment - 1) / Alignment * Alignment;
+            return (bytes + sizeof(Type) - 1) / sizeof(Type);
+        } else {
+            return size;
+        }
+    }
+
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        static_assert(Alignment >= alignof(Type), "Alignment is weaker than the element type requires");
+        if (size > (SIZE_MAX - Alignment) / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t count = PaddedSize<Type>(size);
+        void* memory = ::operator new(count * sizeof(Type), std::align_val_t(Alignment));
+        try {
+            return array_detail::ConstructElements<Type>(memory, count, false);
+        } catch (...) {
+            ::operator delete(memory, std::align_val_t(Alignment));
+            throw;
+        }
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        array_detail::DestroyElements(data, PaddedSize<Type>(size));
+        ::operator delete(data, std::align_val_t(Alignment));
+    }
+};
+
+// SimpleVector с буфером, выровненным на Alignment байт (по умолчанию 64)
+template <typename Type, size_t Alignment = 64, bool PadTail = false>
+using AlignedSimpleVector = SimpleVector<Type, AlignedAllocator<Alignment, PadTail>>;
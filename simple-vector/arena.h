@@ -0,0 +1,214 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+#include <utility>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Монотонный распределитель: память выдаётся сдвигом указателя внутри больших блоков
+// и освобождается вся сразу вызовом Reset. Отдельное освобождение возвращает память
+// только для последнего выделения, и только последнее выделение можно расширить на месте.
+// Объект не потокобезопасен: одна арена обслуживает один поток (например, один запрос)
+class Arena {
+public:
+    static constexpr size_t DEFAULT_BLOCK_SIZE = size_t(64) << 10;
+
+    explicit Arena(size_t block_size = DEFAULT_BLOCK_SIZE) noexcept : block_size_(block_size) {}
+
+    Arena(const Arena&) = delete;
+    Arena& operator=(const Arena&) = delete;
+
+    ~Arena() {
+        ReleaseBlocks(nullptr);
+    }
+
+    // Выделяет bytes байт с выравниванием alignment (степень двойки)
+    void* Allocate(size_t bytes, size_t alignment = alignof(std::max_align_t)) {
+        char* first = AlignUp(current_, alignment);
+        if (current_ == nullptr || first > end_ || bytes > static_cast<size_t>(end_ - first)) {
+            AddBlock(bytes + alignment);
+            first = AlignUp(current_, alignment);
+        }
+        current_ = first + bytes;
+        return first;
+    }
+
+    // Меняет длину последнего выделения data с old_bytes на new_bytes без переноса.
+    // Возвращает false, если data выделено не последним или в блоке не хватает места
+    bool TryResize(void* data, size_t old_bytes, size_t new_bytes) noexcept {
+        char* first = static_cast<char*>(data);
+        if (first + old_bytes != current_ || new_bytes > static_cast<size_t>(end_ - first)) {
+            return false;
+        }
+        current_ = first + new_bytes;
+        return true;
+    }
+
+    // Возвращает память последнего выделения. Для остальных выделений ничего не делает
+    void Free(void* data, size_t bytes) noexcept {
+        TryResize(data, bytes, 0);
+    }
+
+    // Освобождает все выделения сразу. Последний блок сохраняется для следующего использования.
+    // Векторы, выделенные в арене, к этому моменту должны быть разрушены
+    void Reset() noexcept {
+        if (blocks_ != nullptr) {
+            ReleaseBlocks(blocks_);
+            blocks_->next = nullptr;
+            current_ = blocks_->Data();
+            end_ = current_ + blocks_->size;
+            reserved_ = blocks_->size;
+        }
+    }
+
+    // Суммарный размер блоков арены
+    size_t GetReservedBytes() const noexcept {
+        return reserved_;
+    }
+
+    // Арена, из которой ArenaAllocator выделяет память в текущем потоке, или nullptr
+    static Arena* Current() noexcept {
+        return current_arena_;
+    }
+
+private:
+    friend class ArenaScope;
+
+    struct alignas(std::max_align_t) Block {
+        char* Data() noexcept {
+            return reinterpret_cast<char*>(this + 1);
+        }
+
+        Block* next;
+        size_t size;
+    };
+
+    static char* AlignUp(char* pointer, size_t alignment) noexcept {
+        const uintptr_t address = reinterpret_cast<uintptr_t>(pointer);
+        return pointer + ((alignment - address % alignment) % alignment);
+    }
+
+    void AddBlock(size_t min_size) {
+        const size_t size = std::max(block_size_, min_size);
+        Block* block = new (::operator new(sizeof(Block) + size)) Block{blocks_, size};
+        blocks_ = block;
+        current_ = block->Data();
+        end_ = current_ + size;
+        reserved_ += size;
+    }
+
+    // Освобождает блоки, добавленные после keep (все, если keep == nullptr)
+    void ReleaseBlocks(Block* keep) noexcept {
+        Block* block = keep != nullptr ? keep->next : blocks_;
+        while (block != nullptr) {
+            Block* next = block->next;
+            ::operator delete(block);
+            block = next;
+        }
+        if (keep == nullptr) {
+            blocks_ = nullptr;
+        }
+    }
+
+    inline static thread_local Arena* current_arena_ = nullptr;
+
+    size_t block_size_;
+    Block* blocks_ = nullptr;
+    char* current_ = nullptr;
+    char* end_ = nullptr;
+    size_t reserved_ = 0;
+};
+
+// Делает arena текущей для ArenaAllocator в этом потоке на время своего существования.
+// Области вкладываются: при разрушении восстанавливается прежняя арена
+class ArenaScope {
+public:
+    explicit ArenaScope(Arena& arena) noexcept : previous_(std::exchange(Arena::current_arena_, &arena)) {}
+
+    ArenaScope(const ArenaScope&) = delete;
+    ArenaScope& operator=(const ArenaScope&) = delete;
+
+    ~ArenaScope() {
+        Arena::current_arena_ = previous_;
+    }
+
+private:
+    Arena* previous_;
+};
+
+// Распределитель ArrayPtr из текущей арены потока (см. ArenaScope). Перед массивом
+// хранится указатель на его арену, поэтому вектор можно освободить и расширить вне области.
+// Без текущей арены память берётся из кучи. Последний выделенный в арене массив
+// растёт на месте, без переноса элементов
+struct ArenaAllocator {
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        constexpr size_t offset = HeaderOffset<Type>();
+        if (size > (SIZE_MAX - offset) / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = offset + size * sizeof(Type);
+        Arena* arena = Arena::Current();
+        char* memory = arena != nullptr ? static_cast<char*>(arena->Allocate(bytes, offset))
+                                        : static_cast<char*>(::operator new(bytes, std::align_val_t(offset)));
+        *HeaderOf(memory + offset) = arena;
+        try {
+            return array_detail::ConstructElements<Type>(memory + offset, size, false);
+        } catch (...) {
+            Free(memory + offset, offset, bytes);
+            throw;
+        }
+    }
+
+    template <typename Type>
+    static Type* Reallocate(Type* data, size_t old_size, size_t new_size) noexcept {
+        Arena* arena = *HeaderOf(data);
+        if (arena == nullptr || new_size > SIZE_MAX / sizeof(Type)) {
+            return nullptr;
+        }
+        if (!arena->TryResize(data, old_size * sizeof(Type), new_size * sizeof(Type))) {
+            return nullptr;
+        }
+        try {
+            array_detail::ConstructElements<Type>(data + old_size, new_size - old_size, false);
+        } catch (...) {
+            arena->TryResize(data, new_size * sizeof(Type), old_size * sizeof(Type));
+            return nullptr;
+        }
+        return data;
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        array_detail::DestroyElements(data, size);
+        Free(data, HeaderOffset<Type>(), HeaderOffset<Type>() + size * sizeof(Type));
+    }
+
+private:
+    // Заголовок с указателем на арену занимает место перед массивом с учётом выравнивания Type
+    template <typename Type>
+    static constexpr size_t HeaderOffset() noexcept {
+        return std::max(alignof(Type), alignof(std::max_align_t));
+    }
+
+    static Arena** HeaderOf(void* data) noexcept {
+        return reinterpret_cast<Arena**>(static_cast<char*>(data) - sizeof(Arena*));
+    }
+
+    // Возвращает выделение, у которого массив начинается с data, а заголовок занимает offset байт
+    static void Free(void* data, size_t offset, size_t bytes) noexcept {
+        char* memory = static_cast<char*>(data) - offset;
+        if (Arena* arena = *HeaderOf(data); arena != nullptr) {
+            arena->Free(memory, bytes);
+        } else {
+            ::operator delete(memory, std::align_val_t(offset));
+        }
+    }
+};
+
+template <typename Type>
+using ArenaVector = SimpleVector<Type, ArenaAllocator>;
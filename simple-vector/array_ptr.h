@@ -2,28 +2,97 @@
 
 #include <cassert>
 #include <cstdlib>
+#include <new>
+#include <type_traits>
 #include <vector>
 #include <utility>
 
+namespace array_detail {
+
+// Создаёт size элементов, инициализированных значением по умолчанию, в сырой памяти.
+// Если память уже заполнена нулями, тривиальные типы не инициализируются повторно
 template <typename Type>
+Type* ConstructElements(void* memory, size_t size, bool zeroed) {
+    Type* data = static_cast<Type*>(memory);
+    if (std::is_trivial_v<Type> && zeroed) {
+        return data;
+    }
+    size_t constructed = 0;
+    try {
+        for (; constructed < size; ++constructed) {
+            new (data + constructed) Type();
+        }
+    } catch (...) {
+        while (constructed != 0) {
+            data[--constructed].~Type();
+        }
+        throw;
+    }
+    return data;
+}
+
+template <typename Type>
+void DestroyElements(Type* data, size_t size) noexcept {
+    if constexpr (!std::is_trivially_destructible_v<Type>) {
+        for (size_t i = 0; i < size; ++i) {
+            data[i].~Type();
+        }
+    }
+}
+
+// Распределитель умеет увеличивать массив без поэлементного переноса (см. ArrayPtr::TryExtend)
+template <typename Allocator, typename Type, typename = void>
+struct CanReallocate : std::false_type {};
+
+template <typename Allocator, typename Type>
+struct CanReallocate<Allocator, Type,
+                     std::void_t<decltype(Allocator::template Reallocate<Type>(nullptr, size_t(0), size_t(0)))>>
+    : std::true_type {};
+
+}  // namespace array_detail
+
+// Распределитель по умолчанию: массив в куче через new[] и delete[].
+// Другие распределители реализуют те же статические функции Allocate и Deallocate
+struct NewDeleteAllocator {
+    // Создаёт массив из size элементов, инициализированных значением по умолчанию
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        return new Type[size]{};
+    }
+
+    // Разрушает массив, созданный Allocate с тем же size
+    template <typename Type>
+    static void Deallocate(Type* data, size_t /*size*/) noexcept {
+        delete[] data;
+    }
+};
+
+template <typename Type, typename Allocator = NewDeleteAllocator>
 class ArrayPtr {
 public:
     // Инициализирует ArrayPtr нулевым указателем
     ArrayPtr() = default;
 
-    // Создаёт в куче массив из size элементов типа Type.
+    // Создаёт через Allocator массив из size элементов типа Type.
     // Если size == 0, поле raw_ptr_ должно быть равно nullptr
     explicit ArrayPtr(size_t size) {
         if (size != 0){
-            raw_ptr_ = new Type[size]{};
+            raw_ptr_ = Allocator::template Allocate<Type>(size);
+            size_ = size;
         }
     }
 
-    // Конструктор из сырого указателя, хранящего адрес массива в куче либо nullptr
+    // Конструктор из сырого указателя, хранящего адрес массива в куче либо nullptr.
+    // Только для NewDeleteAllocator: остальным распределителям при освобождении нужен размер,
+    // поэтому для них есть лишь конструктор из указателя и размера
+    template <typename Alloc = Allocator, std::enable_if_t<std::is_same_v<Alloc, NewDeleteAllocator>, int> = 0>
     explicit ArrayPtr(Type* raw_ptr) noexcept {
         raw_ptr_ = raw_ptr;
     }
 
+    // Конструктор из сырого указателя на массив из size элементов, созданный Allocator::Allocate
+    ArrayPtr(Type* raw_ptr, size_t size) noexcept : raw_ptr_(raw_ptr), size_(raw_ptr != nullptr ? size : 0) {}
+
     // Запрещаем копирование
     ArrayPtr(const ArrayPtr&) = delete;
 
@@ -31,19 +100,21 @@ public:
     ArrayPtr& operator=(const ArrayPtr&) = delete;
 
     // Конструктор перемещения
-    ArrayPtr(ArrayPtr&& other) {
-        raw_ptr_ = std::move(other.raw_ptr_);
-        other.raw_ptr_ = nullptr;
+    ArrayPtr(ArrayPtr&& other) noexcept {
+        swap(other);
     };
 
-    // Запрещаем присваивание
-    ArrayPtr& operator=(ArrayPtr&& rhs){
-        swap(rhs.raw_ptr);
+    // Присваивание перемещением
+    ArrayPtr& operator=(ArrayPtr&& rhs) noexcept {
+        ArrayPtr tmp(std::move(rhs));
+        swap(tmp);
         return *this;
     };
 
     ~ArrayPtr() {
-        delete[] raw_ptr_;
+        if (raw_ptr_ != nullptr) {
+            Allocator::Deallocate(raw_ptr_, size_);
+        }
     }
 
 
@@ -52,6 +123,7 @@ public:
     [[nodiscard]] Type* Release() noexcept {
         auto tmp = raw_ptr_;
         raw_ptr_ = nullptr;
+        size_ = 0;
         return tmp;
     }
 
@@ -75,13 +147,37 @@ public:
         return raw_ptr_;
     }
 
+    // Пытается увеличить массив до new_size элементов на месте или переносом страниц,
+    // не перемещая элементы по одному. Новые элементы инициализируются значением по умолчанию.
+    // Возвращает false, если распределитель этого не умеет — тогда массив не изменяется
+    bool TryExtend(size_t new_size) {
+        if constexpr (array_detail::CanReallocate<Allocator, Type>::value) {
+            if (raw_ptr_ != nullptr && new_size > size_) {
+                if (Type* extended = Allocator::template Reallocate<Type>(raw_ptr_, size_, new_size)) {
+                    raw_ptr_ = extended;
+                    size_ = new_size;
+                    return true;
+                }
+            }
+        }
+        return false;
+    }
+
+    // Возвращает количество элементов, созданных Allocator. Для массива,
+    // переданного сырым указателем, возвращает 0
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
     // Обменивается значениям указателя на массив с объектом other
     void swap(ArrayPtr& other) noexcept {
         Type *tmp = other.Get();
         other.raw_ptr_ = raw_ptr_;
         raw_ptr_ = tmp;
+        std::swap(size_, other.size_);
     }
 
 private:
     Type* raw_ptr_ = nullptr;
+    size_t size_ = 0;
 };
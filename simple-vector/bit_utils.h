@@ -0,0 +1,46 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+// Номер старшего единичного бита value (value != 0)
+inline size_t HighestBitIndex(uint64_t value) noexcept {
+    assert(value != 0);
+#if defined(__GNUC__) || defined(__clang__)
+    return 63u - static_cast<size_t>(__builtin_clzll(value));
+#else
+    size_t index = 0;
+    while (value >>= 1) {
+        ++index;
+    }
+    return index;
+#endif
+}
+
+// Наименьшая степень двойки, не меньшая value
+inline size_t RoundUpToPowerOfTwo(size_t value) noexcept {
+    return value <= 1 ? 1 : size_t{1} << (HighestBitIndex(value - 1) + 1);
+}
+
+// Раскладка индексов по сегментам, каждый следующий из которых вдвое больше предыдущего:
+// 2^FirstBits, 2^(FirstBits + 1), ... Номер сегмента определяется по старшему биту индекса
+template <size_t FirstBits>
+struct GeometricSegments {
+    static constexpr size_t FIRST_BITS = FirstBits;
+    static constexpr size_t FIRST_SIZE = size_t{1} << FirstBits;
+    static constexpr size_t MAX_SEGMENTS = 64 - FirstBits;
+
+    static size_t SegmentOf(size_t index) noexcept {
+        return HighestBitIndex(index + FIRST_SIZE) - FIRST_BITS;
+    }
+
+    static size_t SegmentSize(size_t segment) noexcept {
+        return FIRST_SIZE << segment;
+    }
+
+    // Индекс первого элемента сегмента. Он же — суммарный размер всех предыдущих сегментов
+    static size_t SegmentFirstIndex(size_t segment) noexcept {
+        return SegmentSize(segment) - FIRST_SIZE;
+    }
+};
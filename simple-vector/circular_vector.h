@@ -0,0 +1,351 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "array_ptr.h"
+#include "index_iterator.h"
+#include "simple_vector.h"
+#include "span.h"
+
+// Поведение CircularVector при вставке в заполненный буфер
+enum class OverflowPolicy {
+    // Увеличить вместимость вдвое, как SimpleVector
+    GROW,
+    // Сохранить вместимость и вытеснить элемент с противоположного конца:
+    // при вставке в начало вытесняется последний элемент, иначе — первый (самый старый)
+    OVERWRITE_OLDEST,
+};
+
+// Вектор на кольцевом буфере. Вставка и удаление с обоих концов выполняются за O(1),
+// вставка и удаление в середине сдвигают меньшую из двух частей
+template <typename Type>
+class CircularVector {
+public:
+    using Iterator = IndexIterator<CircularVector, Type>;
+    using ConstIterator = IndexIterator<const CircularVector, const Type>;
+
+    CircularVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit CircularVector(size_t size) : CircularVector(size, Type()) {}
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    CircularVector(size_t size, const Type& value) : capacity_(size), size_(size), buffer_(size) {
+        std::fill(buffer_.Get(), buffer_.Get() + size, value);
+    }
+
+    // Создаёт пустой вектор заданной вместимости. С политикой OVERWRITE_OLDEST вместимость
+    // не меняется, и буфер работает как скользящее окно из последних элементов
+    explicit CircularVector(ReserveProxyObj capacity, OverflowPolicy policy = OverflowPolicy::GROW)
+        : capacity_(capacity.size), buffer_(capacity.size), policy_(policy) {
+        assert(policy_ == OverflowPolicy::GROW || capacity_ != 0);
+    }
+
+    // Создаёт вектор из std::initializer_list
+    CircularVector(std::initializer_list<Type> init) : capacity_(init.size()), size_(init.size()), buffer_(init.size()) {
+        std::copy(init.begin(), init.end(), buffer_.Get());
+    }
+
+    // Копия скользящего окна сохраняет его вместимость, иначе вместимость равна размеру
+    CircularVector(const CircularVector& other)
+        : capacity_(other.policy_ == OverflowPolicy::OVERWRITE_OLDEST ? other.capacity_ : other.size_),
+          size_(other.size_), buffer_(capacity_), policy_(other.policy_) {
+        std::copy(other.begin(), other.end(), buffer_.Get());
+    }
+
+    CircularVector(CircularVector&& other) noexcept {
+        swap(other);
+    }
+
+    CircularVector& operator=(const CircularVector& rhs) {
+        if (this != &rhs) {
+            CircularVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    CircularVector& operator=(CircularVector&& rhs) noexcept {
+        if (this != &rhs) {
+            CircularVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(CircularVector& other) noexcept {
+        buffer_.swap(other.buffer_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(size_, other.size_);
+        std::swap(head_, other.head_);
+        std::swap(policy_, other.policy_);
+    }
+
+    // Возвращает количество элементов
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает вместимость буфера
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Сообщает, пуст ли вектор
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    OverflowPolicy GetOverflowPolicy() const noexcept {
+        return policy_;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return buffer_[Physical(index)];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return buffer_[Physical(index)];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    Type& Front() noexcept {
+        return (*this)[0];
+    }
+
+    const Type& Front() const noexcept {
+        return (*this)[0];
+    }
+
+    Type& Back() noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    const Type& Back() const noexcept {
+        return (*this)[size_ - 1];
+    }
+
+    // Обнуляет размер, не изменяя вместимость
+    void Clear() noexcept {
+        size_ = 0;
+        head_ = 0;
+    }
+
+    void Reserve(const ReserveProxyObj& obj) {
+        if (obj.size > capacity_) {
+            Reallocate(obj.size);
+        }
+    }
+
+    // Изменяет размер. Новые элементы добавляются в конец и инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Reallocate(std::max(new_size, capacity_ * 2));
+        }
+        for (size_t i = size_; i < new_size; ++i) {
+            buffer_[Physical(i)] = Type();
+        }
+        size_ = new_size;
+    }
+
+    void PushBack(const Type& item) {
+        Insert(end(), item);
+    }
+
+    void PushBack(Type&& item) {
+        Insert(end(), std::move(item));
+    }
+
+    void PushFront(const Type& item) {
+        Insert(begin(), item);
+    }
+
+    void PushFront(Type&& item) {
+        Insert(begin(), std::move(item));
+    }
+
+    // "Удаляет" последний элемент. Для пустого вектора ничего не делает
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+        }
+    }
+
+    // "Удаляет" первый элемент за O(1). Для пустого вектора ничего не делает
+    void PopFront() noexcept {
+        if (size_ != 0) {
+            head_ = Physical(1);
+            --size_;
+        }
+    }
+
+    // Вставляет значение value в позицию pos и возвращает итератор на него
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos.GetIndex(), value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos.GetIndex(), std::move(value));
+    }
+
+    // Удаляет элемент в позиции pos, сдвигая меньшую из частей
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = pos.GetIndex();
+        assert(index < size_);
+        if (index < size_ / 2) {
+            for (size_t i = index; i > 0; --i) {
+                (*this)[i] = std::move((*this)[i - 1]);
+            }
+            head_ = Physical(1);
+        } else {
+            for (size_t i = index; i + 1 < size_; ++i) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+        }
+        --size_;
+        return Iterator(this, index);
+    }
+
+    // Возвращает элементы в виде одного или двух непрерывных участков буфера:
+    // второй участок непуст, только если данные переходят через конец буфера
+    std::pair<Span<Type>, Span<Type>> AsSpans() noexcept {
+        const size_t first = std::min(size_, capacity_ - head_);
+        return {Span<Type>(buffer_.Get() + head_, first), Span<Type>(buffer_.Get(), size_ - first)};
+    }
+
+    std::pair<Span<const Type>, Span<const Type>> AsSpans() const noexcept {
+        const size_t first = std::min(size_, capacity_ - head_);
+        return {Span<const Type>(buffer_.Get() + head_, first), Span<const Type>(buffer_.Get(), size_ - first)};
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    size_t Physical(size_t index) const noexcept {
+        const size_t position = head_ + index;
+        return position >= capacity_ ? position - capacity_ : position;
+    }
+
+    // Переносит элементы в новый буфер, начиная с нулевой позиции
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type> fresh(new_capacity);
+        for (size_t i = 0; i < size_; ++i) {
+            fresh[i] = std::move((*this)[i]);
+        }
+        buffer_.swap(fresh);
+        capacity_ = new_capacity;
+        head_ = 0;
+    }
+
+    template <typename Value>
+    Iterator Emplace(size_t index, Value&& value) {
+        assert(index <= size_);
+        if (size_ == capacity_) {
+            if (policy_ == OverflowPolicy::OVERWRITE_OLDEST) {
+                if (index == 0) {
+                    PopBack();
+                } else {
+                    PopFront();
+                    --index;
+                }
+            } else {
+                Reallocate(std::max<size_t>(capacity_ * 2, 1));
+            }
+        }
+        if (index < size_ / 2) {
+            head_ = head_ == 0 ? capacity_ - 1 : head_ - 1;
+            ++size_;
+            for (size_t i = 0; i < index; ++i) {
+                (*this)[i] = std::move((*this)[i + 1]);
+            }
+        } else {
+            ++size_;
+            for (size_t i = size_ - 1; i > index; --i) {
+                (*this)[i] = std::move((*this)[i - 1]);
+            }
+        }
+        (*this)[index] = std::forward<Value>(value);
+        return Iterator(this, index);
+    }
+
+    size_t capacity_ = 0;
+    size_t size_ = 0;
+    size_t head_ = 0;
+    ArrayPtr<Type> buffer_;
+    OverflowPolicy policy_ = OverflowPolicy::GROW;
+};
+
+template <typename Type>
+inline bool operator==(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator!=(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator<=(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const CircularVector<Type>& lhs, const CircularVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
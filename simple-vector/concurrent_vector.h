@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <new>
+#include <stdexcept>
+#include <utility>
+
+#include "bit_utils.h"
+
+// Растущий вектор с неблокирующим PushBack из многих потоков.
+// Элементы хранятся в сегментах размером FIRST_SEGMENT_SIZE, 2*FIRST_SEGMENT_SIZE, 4*FIRST_SEGMENT_SIZE...
+// Сегменты никогда не перемещаются, поэтому ссылки на элементы остаются действительными.
+// Читатели видят только опубликованный префикс: элементы [0, GetSize()) полностью сконструированы
+template <typename Type>
+class ConcurrentSimpleVector {
+    struct Slot {
+        std::atomic<bool> ready{false};
+        alignas(Type) unsigned char storage[sizeof(Type)];
+
+        Type* Get() noexcept {
+            return std::launder(reinterpret_cast<Type*>(storage));
+        }
+    };
+
+public:
+    static constexpr size_t FIRST_SEGMENT_BITS = 6;
+    static constexpr size_t FIRST_SEGMENT_SIZE = GeometricSegments<FIRST_SEGMENT_BITS>::FIRST_SIZE;
+    static constexpr size_t MAX_SEGMENTS = GeometricSegments<FIRST_SEGMENT_BITS>::MAX_SEGMENTS;
+
+    ConcurrentSimpleVector() noexcept = default;
+
+    ConcurrentSimpleVector(const ConcurrentSimpleVector&) = delete;
+    ConcurrentSimpleVector& operator=(const ConcurrentSimpleVector&) = delete;
+
+    // Не должен вызываться одновременно с другими методами
+    ~ConcurrentSimpleVector() {
+        const size_t claimed = claimed_.load();
+        for (size_t segment = 0; segment < MAX_SEGMENTS; ++segment) {
+            Slot* slots = segments_[segment].load();
+            if (slots == nullptr) {
+                continue;
+            }
+            const size_t first = Layout::SegmentFirstIndex(segment);
+            for (size_t i = 0; i < Layout::SegmentSize(segment) && first + i < claimed; ++i) {
+                if (slots[i].ready.load()) {
+                    slots[i].Get()->~Type();
+                }
+            }
+            delete[] slots;
+        }
+    }
+
+    // Добавляет элемент в конец вектора и возвращает его индекс.
+    // Если конструктор элемента выбросит исключение, занятая ячейка и все последующие
+    // останутся неопубликованными
+    size_t PushBack(const Type& item) {
+        return EmplaceBack(item);
+    }
+
+    size_t PushBack(Type&& item) {
+        return EmplaceBack(std::move(item));
+    }
+
+    template <typename... Args>
+    size_t EmplaceBack(Args&&... args) {
+        const size_t index = claimed_.fetch_add(1);
+        Slot& slot = SlotAt(index, true);
+        new (slot.storage) Type(std::forward<Args>(args)...);
+        slot.ready.store(true);
+        Publish();
+        return index;
+    }
+
+    // Количество опубликованных элементов
+    size_t GetSize() const noexcept {
+        return size_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Возвращает ссылку на элемент с индексом index < GetSize()
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return *SlotAt(index, false).Get();
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return *const_cast<ConcurrentSimpleVector*>(this)->SlotAt(index, false).Get();
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= GetSize()
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+private:
+    using Layout = GeometricSegments<FIRST_SEGMENT_BITS>;
+
+    // Находит ячейку по индексу. При allocate == true недостающий сегмент выделяется;
+    // если несколько потоков выделили его одновременно, остаётся установленный первым
+    Slot& SlotAt(size_t index, bool allocate) {
+        const size_t segment = Layout::SegmentOf(index);
+        Slot* slots = segments_[segment].load(std::memory_order_acquire);
+        if (slots == nullptr && allocate) {
+            Slot* fresh = new Slot[Layout::SegmentSize(segment)];
+            if (segments_[segment].compare_exchange_strong(slots, fresh, std::memory_order_acq_rel)) {
+                slots = fresh;
+            } else {
+                delete[] fresh;
+            }
+        }
+        assert(slots != nullptr);
+        return slots[index - Layout::SegmentFirstIndex(segment)];
+    }
+
+    // Сдвигает границу опубликованных элементов, пока следующая ячейка готова.
+    // Границу двигает тот поток, который завершает непрерывный участок готовых ячеек
+    void Publish() noexcept {
+        size_t size = size_.load();
+        while (size < claimed_.load()) {
+            Slot* slots = segments_[Layout::SegmentOf(size)].load();
+            if (slots == nullptr || !slots[size - Layout::SegmentFirstIndex(Layout::SegmentOf(size))].ready.load()) {
+                return;
+            }
+            if (size_.compare_exchange_weak(size, size + 1)) {
+                ++size;
+            }
+        }
+    }
+
+    std::atomic<Slot*> segments_[MAX_SEGMENTS] = {};
+    alignas(64) std::atomic<size_t> claimed_{0};
+    alignas(64) std::atomic<size_t> size_{0};
+};
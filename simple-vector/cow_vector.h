@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <initializer_list>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Вектор с копированием при записи. Копии разделяют один буфер со счётчиком ссылок,
+// поэтому копирование стоит O(1), а данные копируются при первом изменяющем обращении
+// к разделяемому буферу. Неконстантные operator[], At, begin/end, GetMutable, Insert и Erase
+// выдают ссылки, через которые можно писать и позже, поэтому копии, сделанные после них,
+// сразу получают собственный буфер — пока вектор не перевыделит память (PushBack, Reserve,
+// Resize) и прежние ссылки не станут недействительными. Для чтения используйте константный
+// доступ или Get(), чтобы копии оставались дешёвыми.
+// Счётчик ссылок атомарный, поэтому копии можно передавать в другие потоки.
+// Один и тот же объект CowVector, как и SimpleVector, нельзя изменять из нескольких потоков
+template <typename Type>
+class CowVector {
+    struct SharedBuffer {
+        explicit SharedBuffer(SimpleVector<Type> items) : data(std::move(items)) {}
+
+        // Изменяемые ссылки, выданные на текущий буфер data, ещё действительны
+        bool IsUnshareable() const noexcept {
+            return exposed != nullptr && exposed == data.begin();
+        }
+
+        std::atomic<size_t> references{1};
+        // Начало data на момент выдачи изменяемых ссылок. После перевыделения памяти data
+        // не совпадает с ним, и буфер снова можно разделять. Меняется только единственным владельцем
+        const Type* exposed = nullptr;
+        SimpleVector<Type> data;
+    };
+
+public:
+    using Iterator = typename SimpleVector<Type>::Iterator;
+    using ConstIterator = typename SimpleVector<Type>::ConstIterator;
+
+    CowVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit CowVector(size_t size) : CowVector(SimpleVector<Type>(size)) {}
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    CowVector(size_t size, const Type& value) : CowVector(SimpleVector<Type>(size, value)) {}
+
+    explicit CowVector(ReserveProxyObj capacity) : CowVector(SimpleVector<Type>(capacity)) {}
+
+    // Создаёт вектор из std::initializer_list
+    CowVector(std::initializer_list<Type> init) : CowVector(SimpleVector<Type>(init)) {}
+
+    // Забирает содержимое SimpleVector без копирования
+    explicit CowVector(SimpleVector<Type>&& data) : buffer_(new SharedBuffer(std::move(data))) {}
+
+    // Разделяет буфер с other за O(1). Если у other выданы изменяемые ссылки, копирует элементы
+    CowVector(const CowVector& other) {
+        if (other.buffer_ == nullptr) {
+            return;
+        }
+        if (other.buffer_->IsUnshareable()) {
+            buffer_ = new SharedBuffer(other.buffer_->data);
+        } else {
+            buffer_ = other.buffer_;
+            buffer_->references.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    CowVector(CowVector&& other) noexcept : buffer_(std::exchange(other.buffer_, nullptr)) {}
+
+    CowVector& operator=(const CowVector& rhs) {
+        CowVector tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+
+    CowVector& operator=(CowVector&& rhs) noexcept {
+        CowVector tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    ~CowVector() {
+        Release();
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(CowVector& other) noexcept {
+        std::swap(buffer_, other.buffer_);
+    }
+
+    // Сообщает, разделяет ли вектор буфер с другими копиями
+    bool IsShared() const noexcept {
+        return buffer_ != nullptr && buffer_->references.load(std::memory_order_acquire) > 1;
+    }
+
+    // Возвращает содержимое только для чтения, не вызывая копирования
+    const SimpleVector<Type>& Get() const noexcept {
+        return buffer_ != nullptr ? buffer_->data : Empty();
+    }
+
+    // Возвращает содержимое для изменения, при необходимости копируя разделяемый буфер.
+    // Буфер не разделяется с будущими копиями, пока не перевыделит память
+    SimpleVector<Type>& GetMutable() {
+        Detach();
+        return Expose();
+    }
+
+    size_t GetSize() const noexcept {
+        return Get().GetSize();
+    }
+
+    size_t GetCapacity() const noexcept {
+        return Get().GetCapacity();
+    }
+
+    bool IsEmpty() const noexcept {
+        return Get().IsEmpty();
+    }
+
+    Type& operator[](size_t index) {
+        return GetMutable()[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return Get()[index];
+    }
+
+    Type& At(size_t index) {
+        Get().At(index);
+        return GetMutable()[index];
+    }
+
+    const Type& At(size_t index) const {
+        return Get().At(index);
+    }
+
+    void Clear() {
+        if (IsShared()) {
+            CowVector tmp;
+            swap(tmp);
+        } else if (buffer_ != nullptr) {
+            buffer_->data.Clear();
+        }
+    }
+
+    void Reserve(const ReserveProxyObj& obj) {
+        if (obj.size > GetCapacity()) {
+            Exclusive().Reserve(obj);
+        }
+    }
+
+    void Resize(size_t new_size) {
+        if (new_size != GetSize()) {
+            Exclusive().Resize(new_size);
+        }
+    }
+
+    void PushBack(const Type& item) {
+        Exclusive().PushBack(item);
+    }
+
+    void PushBack(Type&& item) {
+        Exclusive().PushBack(std::move(item));
+    }
+
+    void PopBack() {
+        if (!IsEmpty()) {
+            Exclusive().PopBack();
+        }
+    }
+
+    // pos может указывать в разделяемый буфер: позиция пересчитывается после копирования
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        const auto index = pos - cbegin();
+        SimpleVector<Type>& data = Exclusive();
+        const Iterator result = data.Insert(data.begin() + index, value);
+        Expose();
+        return result;
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        const auto index = pos - cbegin();
+        SimpleVector<Type>& data = Exclusive();
+        const Iterator result = data.Insert(data.begin() + index, std::move(value));
+        Expose();
+        return result;
+    }
+
+    Iterator Erase(ConstIterator pos) {
+        const auto index = pos - cbegin();
+        SimpleVector<Type>& data = Exclusive();
+        const Iterator result = data.Erase(data.begin() + index);
+        Expose();
+        return result;
+    }
+
+    // Неконстантные итераторы дают право на запись и поэтому копируют разделяемый буфер.
+    // Пустой вектор буфер не выделяет
+    Iterator begin() {
+        return buffer_ != nullptr ? GetMutable().begin() : nullptr;
+    }
+
+    Iterator end() {
+        return buffer_ != nullptr ? GetMutable().end() : nullptr;
+    }
+
+    ConstIterator begin() const noexcept {
+        return Get().begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return Get().end();
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return Get().begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return Get().end();
+    }
+
+private:
+    static const SimpleVector<Type>& Empty() noexcept {
+        static const SimpleVector<Type> empty;
+        return empty;
+    }
+
+    // Содержимое для изменения внутри CowVector: ссылки наружу не выдаются,
+    // поэтому буфер остаётся разделяемым
+    SimpleVector<Type>& Exclusive() {
+        Detach();
+        return buffer_->data;
+    }
+
+    // Запоминает, что на элементы текущего буфера выданы изменяемые ссылки
+    SimpleVector<Type>& Expose() noexcept {
+        buffer_->exposed = buffer_->data.begin();
+        return buffer_->data;
+    }
+
+    // Делает буфер единоличным, копируя его, если на него ссылается кто-то ещё
+    void Detach() {
+        if (buffer_ == nullptr) {
+            buffer_ = new SharedBuffer(SimpleVector<Type>());
+        } else if (IsShared()) {
+            SharedBuffer* copy = new SharedBuffer(buffer_->data);
+            Release();
+            buffer_ = copy;
+        }
+    }
+
+    void Release() noexcept {
+        if (buffer_ != nullptr && buffer_->references.fetch_sub(1, std::memory_order_acq_rel) == 1) {
+            delete buffer_;
+        }
+        buffer_ = nullptr;
+    }
+
+    SharedBuffer* buffer_ = nullptr;
+};
+
+template <typename Type>
+inline bool operator==(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return lhs.Get() == rhs.Get();
+}
+
+template <typename Type>
+inline bool operator!=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return lhs.Get() < rhs.Get();
+}
+
+template <typename Type>
+inline bool operator<=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const CowVector<Type>& lhs, const CowVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,298 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "array_ptr.h"
+#include "index_iterator.h"
+#include "simple_vector.h"
+
+// Вектор с подвижным промежутком (gap buffer) для правок вокруг курсора.
+// Свободное место хранится не в конце, а в позиции последней правки, поэтому
+// вставка и удаление рядом с ней стоят O(1), а перенос промежутка на d позиций — O(d)
+template <typename Type>
+class GapVector {
+public:
+    using Iterator = IndexIterator<GapVector, Type>;
+    using ConstIterator = IndexIterator<const GapVector, const Type>;
+
+    GapVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit GapVector(size_t size) : GapVector(size, Type()) {}
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    GapVector(size_t size, const Type& value) : capacity_(size), gap_begin_(size), gap_end_(size), buffer_(size) {
+        std::fill(buffer_.Get(), buffer_.Get() + size, value);
+    }
+
+    explicit GapVector(ReserveProxyObj capacity) : capacity_(capacity.size), gap_end_(capacity.size), buffer_(capacity.size) {}
+
+    // Создаёт вектор из std::initializer_list
+    GapVector(std::initializer_list<Type> init)
+        : capacity_(init.size()), gap_begin_(init.size()), gap_end_(init.size()), buffer_(init.size()) {
+        std::copy(init.begin(), init.end(), buffer_.Get());
+    }
+
+    GapVector(const GapVector& other)
+        : capacity_(other.GetSize()), gap_begin_(other.GetSize()), gap_end_(other.GetSize()), buffer_(other.GetSize()) {
+        std::copy(other.begin(), other.end(), buffer_.Get());
+    }
+
+    GapVector(GapVector&& other) noexcept {
+        swap(other);
+    }
+
+    GapVector& operator=(const GapVector& rhs) {
+        if (this != &rhs) {
+            GapVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    GapVector& operator=(GapVector&& rhs) noexcept {
+        if (this != &rhs) {
+            GapVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(GapVector& other) noexcept {
+        buffer_.swap(other.buffer_);
+        std::swap(capacity_, other.capacity_);
+        std::swap(gap_begin_, other.gap_begin_);
+        std::swap(gap_end_, other.gap_end_);
+    }
+
+    // Возвращает количество элементов
+    size_t GetSize() const noexcept {
+        return capacity_ - (gap_end_ - gap_begin_);
+    }
+
+    // Возвращает вместимость буфера
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Сообщает, пуст ли вектор
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Позиция промежутка: индекс, перед которым вставка выполняется за O(1)
+    size_t GetGapPosition() const noexcept {
+        return gap_begin_;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < GetSize());
+        return buffer_[Physical(index)];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < GetSize());
+        return buffer_[Physical(index)];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= GetSize()) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Обнуляет размер, не изменяя вместимость
+    void Clear() noexcept {
+        gap_begin_ = 0;
+        gap_end_ = capacity_;
+    }
+
+    void Reserve(const ReserveProxyObj& obj) {
+        if (obj.size > capacity_) {
+            Reallocate(obj.size);
+        }
+    }
+
+    // Изменяет размер. Новые элементы добавляются в конец и инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        const size_t size = GetSize();
+        if (new_size <= size) {
+            MoveGap(new_size);
+            gap_end_ = capacity_;
+            return;
+        }
+        if (new_size > capacity_) {
+            Reallocate(std::max(new_size, capacity_ * 2));
+        }
+        MoveGap(size);
+        std::fill(buffer_.Get() + gap_begin_, buffer_.Get() + new_size, Type());
+        gap_begin_ = new_size;
+    }
+
+    // Переносит промежуток к позиции index, сдвигая элементы между старой и новой позицией
+    void MoveGap(size_t index) {
+        assert(index <= GetSize());
+        Type* data = buffer_.Get();
+        if (index < gap_begin_) {
+            std::move_backward(data + index, data + gap_begin_, data + gap_end_);
+            gap_end_ -= gap_begin_ - index;
+            gap_begin_ = index;
+        } else if (index > gap_begin_) {
+            const size_t count = index - gap_begin_;
+            std::move(data + gap_end_, data + gap_end_ + count, data + gap_begin_);
+            gap_end_ += count;
+            gap_begin_ = index;
+        }
+    }
+
+    void PushBack(const Type& item) {
+        Insert(end(), item);
+    }
+
+    void PushBack(Type&& item) {
+        Insert(end(), std::move(item));
+    }
+
+    // "Удаляет" последний элемент. Для пустого вектора ничего не делает
+    void PopBack() {
+        if (!IsEmpty()) {
+            Erase(end() - 1);
+        }
+    }
+
+    // Вставляет значение value в позицию pos и возвращает итератор на него.
+    // Промежуток остаётся сразу после вставленного элемента
+    Iterator Insert(ConstIterator pos, const Type& value) {
+        return Emplace(pos.GetIndex(), value);
+    }
+
+    Iterator Insert(ConstIterator pos, Type&& value) {
+        return Emplace(pos.GetIndex(), std::move(value));
+    }
+
+    // Удаляет элемент в позиции pos. Удаление элемента прямо перед промежутком
+    // (как Backspace у курсора) не сдвигает ничего
+    Iterator Erase(ConstIterator pos) {
+        const size_t index = pos.GetIndex();
+        assert(index < GetSize());
+        if (index + 1 == gap_begin_) {
+            --gap_begin_;
+        } else {
+            MoveGap(index);
+            ++gap_end_;
+        }
+        return Iterator(this, index);
+    }
+
+    // Переносит элементы в непрерывный SimpleVector. GapVector становится пустым
+    SimpleVector<Type> Compact() {
+        SimpleVector<Type> result(::Reserve(GetSize()));
+        MoveGap(GetSize());
+        for (size_t i = 0; i < gap_begin_; ++i) {
+            result.PushBack(std::move(buffer_[i]));
+        }
+        Clear();
+        return result;
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, GetSize());
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, GetSize());
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    size_t Physical(size_t index) const noexcept {
+        return index < gap_begin_ ? index : index + (gap_end_ - gap_begin_);
+    }
+
+    // Переносит элементы в новый буфер, сохраняя позицию промежутка
+    void Reallocate(size_t new_capacity) {
+        ArrayPtr<Type> fresh(new_capacity);
+        const size_t tail = capacity_ - gap_end_;
+        std::move(buffer_.Get(), buffer_.Get() + gap_begin_, fresh.Get());
+        std::move(buffer_.Get() + gap_end_, buffer_.Get() + capacity_, fresh.Get() + new_capacity - tail);
+        buffer_.swap(fresh);
+        gap_end_ = new_capacity - tail;
+        capacity_ = new_capacity;
+    }
+
+    template <typename Value>
+    Iterator Emplace(size_t index, Value&& value) {
+        assert(index <= GetSize());
+        if (gap_begin_ == gap_end_) {
+            Reallocate(std::max<size_t>(capacity_ * 2, 1));
+        }
+        MoveGap(index);
+        buffer_[gap_begin_++] = std::forward<Value>(value);
+        return Iterator(this, index);
+    }
+
+    size_t capacity_ = 0;
+    size_t gap_begin_ = 0;
+    size_t gap_end_ = 0;
+    ArrayPtr<Type> buffer_;
+};
+
+template <typename Type>
+inline bool operator==(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator!=(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator<=(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const GapVector<Type>& lhs, const GapVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cstdint>
+#include <fstream>
+#include <iterator>
+#include <new>
+#include <string>
+#include <type_traits>
+
+#include <sys/mman.h>
+
+#include "array_ptr.h"
+
+// Распределитель, размещающий большие массивы на огромных страницах (2 МБ), чтобы
+// произвольный доступ к многогигабайтным таблицам реже промахивался мимо TLB.
+// Массивы от MIN_BYTES получают анонимное отображение, выровненное на 2 МБ, с
+// madvise(MADV_HUGEPAGE). Если прозрачные огромные страницы выключены, пробуется
+// явный MAP_HUGETLB из заранее выделенного системой пула, а без него — обычные страницы.
+// Массивы меньше порога остаются в куче. Отображённые массивы тривиальных элементов
+// растут через mremap: ядро переносит таблицы страниц, и байты не копируются.
+// Пример: SimpleVector<uint64_t, HugePageAllocator> table(size);
+struct HugePageAllocator {
+    static constexpr size_t HUGE_PAGE_SIZE = size_t(2) << 20;
+    static constexpr size_t MIN_BYTES = HUGE_PAGE_SIZE;
+
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        if (size > (SIZE_MAX - 2 * HUGE_PAGE_SIZE) / sizeof(Type)) {
+            throw std::bad_alloc();
+        }
+        if (!IsMapped(size * sizeof(Type))) {
+            return NewDeleteAllocator::Allocate<Type>(size);
+        }
+        const size_t length = MappingLength(size * sizeof(Type));
+        void* memory = Map(length);
+        try {
+            return array_detail::ConstructElements<Type>(memory, size, true);
+        } catch (...) {
+            ::munmap(memory, length);
+            throw;
+        }
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        if (!IsMapped(size * sizeof(Type))) {
+            NewDeleteAllocator::Deallocate(data, size);
+            return;
+        }
+        array_detail::DestroyElements(data, size);
+        ::munmap(data, MappingLength(size * sizeof(Type)));
+    }
+
+    // Увеличивает отображённый массив тривиальных элементов, перенося страницы через mremap
+    // в новое выровненное отображение без копирования байтов. Возвращает nullptr, если
+    // массив лежит в куче или ядро не смогло перенести отображение
+    template <typename Type>
+    static Type* Reallocate(Type* data, size_t old_size, size_t new_size) noexcept {
+        if constexpr (!std::is_trivial_v<Type>) {
+            return nullptr;
+        } else {
+            if (!IsMapped(old_size * sizeof(Type)) || new_size > (SIZE_MAX - 2 * HUGE_PAGE_SIZE) / sizeof(Type)) {
+                return nullptr;
+            }
+            const size_t old_length = MappingLength(old_size * sizeof(Type));
+            const size_t new_length = MappingLength(new_size * sizeof(Type));
+            if (new_length == old_length) {
+                return data;
+            }
+#if defined(MREMAP_FIXED)
+            void* target = MapAligned(new_length);
+            if (target == nullptr) {
+                return nullptr;
+            }
+            void* moved = ::mremap(data, old_length, new_length, MREMAP_MAYMOVE | MREMAP_FIXED, target);
+            if (moved == MAP_FAILED) {
+                ::munmap(target, new_length);
+                return nullptr;
+            }
+            return static_cast<Type*>(moved);
+#else
+            return nullptr;
+#endif
+        }
+    }
+
+    // Сообщает, будет ли массив из bytes байт размещён в отдельном отображении
+    static bool IsMapped(size_t bytes) noexcept {
+        return bytes >= MIN_BYTES;
+    }
+
+    // Длина отображения: bytes, округлённое вверх до огромной страницы
+    static size_t MappingLength(size_t bytes) noexcept {
+        return (bytes + HUGE_PAGE_SIZE - 1) / HUGE_PAGE_SIZE * HUGE_PAGE_SIZE;
+    }
+
+    // Включены ли прозрачные огромные страницы (режим always или madvise)
+    static bool TransparentHugePagesEnabled() {
+        static const bool enabled = [] {
+            std::ifstream settings("/sys/kernel/mm/transparent_hugepage/enabled");
+            const std::string mode{std::istreambuf_iterator<char>(settings), std::istreambuf_iterator<char>()};
+            return !mode.empty() && mode.find("[never]") == std::string::npos;
+        }();
+        return enabled;
+    }
+
+private:
+    static void* Map(size_t length) {
+#if defined(MAP_HUGETLB)
+        if (!TransparentHugePagesEnabled()) {
+            int flags = MAP_PRIVATE | MAP_ANONYMOUS | MAP_HUGETLB;
+#if defined(MAP_HUGE_SHIFT)
+            flags |= 21 << MAP_HUGE_SHIFT;
+#endif
+            void* memory = ::mmap(nullptr, length, PROT_READ | PROT_WRITE, flags, -1, 0);
+            if (memory != MAP_FAILED) {
+                return memory;
+            }
+        }
+#endif
+        void* memory = MapAligned(length);
+        if (memory == nullptr) {
+            throw std::bad_alloc();
+        }
+        return memory;
+    }
+
+    // Отображение длины length, выровненное на огромную страницу, или nullptr
+    static void* MapAligned(size_t length) noexcept {
+        // Берём отображение с запасом в одну огромную страницу и срезаем края до выровненного участка
+        void* raw = ::mmap(nullptr, length + HUGE_PAGE_SIZE, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+        if (raw == MAP_FAILED) {
+            return nullptr;
+        }
+        char* first = static_cast<char*>(raw);
+        const size_t head = (HUGE_PAGE_SIZE - reinterpret_cast<uintptr_t>(first) % HUGE_PAGE_SIZE) % HUGE_PAGE_SIZE;
+        char* aligned = first + head;
+        if (head != 0) {
+            ::munmap(first, head);
+        }
+        ::munmap(aligned + length, HUGE_PAGE_SIZE - head);
+#if defined(MADV_HUGEPAGE)
+        ::madvise(aligned, length, MADV_HUGEPAGE);
+#endif
+        return aligned;
+    }
+};
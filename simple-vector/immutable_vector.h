@@ -0,0 +1,568 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <stdexcept>
+#include <utility>
+
+#include "index_iterator.h"
+#include "simple_vector.h"
+
+// Неизменяемый (персистентный) вектор на RRB-дереве (relaxed radix balanced tree)
+// с узлами шириной WIDTH. Операции Set, PushBack, Concat и Slice возвращают новую версию
+// за O(log32 n), а старая версия остаётся действительной. Версии разделяют неизменённые
+// поддеревья, поэтому хранение многих версий не требует копирования всего вектора.
+// Каждый внутренний узел хранит накопленные размеры детей, поэтому индексирование работает
+// и для неплотных узлов, которые появляются после Concat и Slice.
+// Счётчики ссылок узлов атомарные: версии можно свободно передавать между потоками
+template <typename Type>
+class ImmutableVector {
+public:
+    static constexpr size_t BITS = 5;
+    static constexpr size_t WIDTH = size_t{1} << BITS;
+
+private:
+    struct Node {
+        std::atomic<size_t> references{1};
+        size_t count = 0;
+    };
+
+    struct Leaf : Node {
+        Type items[WIDTH];
+    };
+
+    struct Branch : Node {
+        Node* children[WIDTH] = {};
+        // sizes[i] — количество элементов в детях с 0 по i включительно
+        size_t sizes[WIDTH] = {};
+    };
+
+public:
+    using ConstIterator = IndexIterator<const ImmutableVector, const Type>;
+
+    // Пакетный режим: изменения применяются на месте к узлам, которыми он владеет единолично,
+    // поэтому серия PushBack или Set не создаёт промежуточных версий.
+    // Исходная версия, из которой создан Transient, не меняется
+    class Transient {
+    public:
+        explicit Transient(ImmutableVector base) noexcept : vector_(std::move(base)) {}
+
+        size_t GetSize() const noexcept {
+            return vector_.GetSize();
+        }
+
+        const Type& operator[](size_t index) const noexcept {
+            return vector_[index];
+        }
+
+        void PushBack(Type value) {
+            vector_.PushBackInPlace(std::move(value));
+        }
+
+        void Set(size_t index, Type value) {
+            vector_.SetInPlace(index, std::move(value));
+        }
+
+        // Завершает пакетный режим и возвращает получившуюся версию
+        ImmutableVector Persistent() && noexcept {
+            return std::move(vector_);
+        }
+
+    private:
+        ImmutableVector vector_;
+    };
+
+    ImmutableVector() noexcept = default;
+
+    ImmutableVector(const ImmutableVector& other) noexcept
+        : root_(Retain(other.root_)), shift_(other.shift_), size_(other.size_) {}
+
+    ImmutableVector(ImmutableVector&& other) noexcept {
+        swap(other);
+    }
+
+    ImmutableVector& operator=(const ImmutableVector& rhs) noexcept {
+        ImmutableVector tmp(rhs);
+        swap(tmp);
+        return *this;
+    }
+
+    ImmutableVector& operator=(ImmutableVector&& rhs) noexcept {
+        ImmutableVector tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    ~ImmutableVector() {
+        Release(root_, shift_);
+    }
+
+    void swap(ImmutableVector& other) noexcept {
+        std::swap(root_, other.root_);
+        std::swap(shift_, other.shift_);
+        std::swap(size_, other.size_);
+    }
+
+    // Строит дерево снизу вверх за O(n)
+    static ImmutableVector FromSimpleVector(const SimpleVector<Type>& items) {
+        ImmutableVector result;
+        if (items.IsEmpty()) {
+            return result;
+        }
+        SimpleVector<Node*> level((items.GetSize() + WIDTH - 1) / WIDTH);
+        for (size_t i = 0; i < level.GetSize(); ++i) {
+            auto* leaf = new Leaf;
+            leaf->count = std::min(WIDTH, items.GetSize() - i * WIDTH);
+            std::copy(items.begin() + i * WIDTH, items.begin() + i * WIDTH + leaf->count, leaf->items);
+            level[i] = leaf;
+        }
+        size_t shift = 0;
+        while (level.GetSize() > 1) {
+            SimpleVector<Node*> parents((level.GetSize() + WIDTH - 1) / WIDTH);
+            for (size_t i = 0; i < parents.GetSize(); ++i) {
+                auto* branch = new Branch;
+                for (size_t child = i * WIDTH; child < std::min(level.GetSize(), (i + 1) * WIDTH); ++child) {
+                    AppendChild(branch, level[child], shift);
+                }
+                parents[i] = branch;
+            }
+            level.swap(parents);
+            shift += BITS;
+        }
+        result.root_ = level[0];
+        result.shift_ = shift;
+        result.size_ = items.GetSize();
+        return result;
+    }
+
+    // Копирует элементы в SimpleVector за O(n)
+    SimpleVector<Type> ToSimpleVector() const {
+        SimpleVector<Type> result(size_);
+        size_t position = 0;
+        CopyTo(root_, shift_, result, position);
+        return result;
+    }
+
+    Transient ToTransient() const noexcept {
+        return Transient(*this);
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        const Node* node = root_;
+        for (size_t shift = shift_; shift > 0; shift -= BITS) {
+            const auto* branch = static_cast<const Branch*>(node);
+            node = branch->children[Locate(branch, shift, index)];
+        }
+        return static_cast<const Leaf*>(node)->items[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Возвращает версию, в которой элемент index заменён на value
+    ImmutableVector Set(size_t index, Type value) const {
+        ImmutableVector result(*this);
+        result.SetInPlace(index, std::move(value));
+        return result;
+    }
+
+    // Возвращает версию с value в конце
+    ImmutableVector PushBack(Type value) const {
+        ImmutableVector result(*this);
+        result.PushBackInPlace(std::move(value));
+        return result;
+    }
+
+    // Возвращает конкатенацию с other. Сливаются только узлы на стыке деревьев
+    ImmutableVector Concat(const ImmutableVector& other) const {
+        if (other.IsEmpty()) {
+            return *this;
+        }
+        if (IsEmpty()) {
+            return other;
+        }
+        Node* left = Retain(root_);
+        Node* right = Retain(other.root_);
+        size_t shift = std::max(shift_, other.shift_);
+        for (size_t s = shift_; s < shift; s += BITS) {
+            left = Wrap(left, s);
+        }
+        for (size_t s = other.shift_; s < shift; s += BITS) {
+            right = Wrap(right, s);
+        }
+        Node* merged[2];
+        const size_t count = ConcatNodes(left, right, shift, merged);
+        Release(left, shift);
+        Release(right, shift);
+
+        ImmutableVector result;
+        result.size_ = size_ + other.size_;
+        if (count == 1) {
+            result.root_ = merged[0];
+            result.shift_ = shift;
+        } else {
+            auto* root = new Branch;
+            AppendChild(root, merged[0], shift);
+            AppendChild(root, merged[1], shift);
+            result.root_ = root;
+            result.shift_ = shift + BITS;
+        }
+        result.Collapse();
+        return result;
+    }
+
+    // Возвращает версию из элементов [first, last)
+    ImmutableVector Slice(size_t first, size_t last) const {
+        assert(first <= last && last <= size_);
+        ImmutableVector result;
+        if (first == last) {
+            return result;
+        }
+        Node* taken = Take(root_, shift_, last);
+        result.root_ = first == 0 ? taken : Drop(taken, shift_, first);
+        if (first != 0) {
+            Release(taken, shift_);
+        }
+        result.shift_ = shift_;
+        result.size_ = last - first;
+        result.Collapse();
+        return result;
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    static Node* Retain(Node* node) noexcept {
+        if (node != nullptr) {
+            node->references.fetch_add(1, std::memory_order_relaxed);
+        }
+        return node;
+    }
+
+    static void Release(Node* node, size_t shift) noexcept {
+        if (node == nullptr || node->references.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+            return;
+        }
+        if (shift == 0) {
+            delete static_cast<Leaf*>(node);
+            return;
+        }
+        auto* branch = static_cast<Branch*>(node);
+        for (size_t i = 0; i < branch->count; ++i) {
+            Release(branch->children[i], shift - BITS);
+        }
+        delete branch;
+    }
+
+    static size_t NodeSize(const Node* node, size_t shift) noexcept {
+        return shift == 0 ? node->count : static_cast<const Branch*>(node)->sizes[node->count - 1];
+    }
+
+    // Добавляет ребёнка, передавая ему владение ссылкой
+    static void AppendChild(Branch* branch, Node* child, size_t child_shift) noexcept {
+        assert(branch->count < WIDTH);
+        const size_t before = branch->count == 0 ? 0 : branch->sizes[branch->count - 1];
+        branch->children[branch->count] = child;
+        branch->sizes[branch->count] = before + NodeSize(child, child_shift);
+        ++branch->count;
+    }
+
+    // Находит ребёнка, содержащего элемент index, и делает index относительным.
+    // Ребёнок i содержит не больше (i + 1) << shift элементов, поэтому index >> shift —
+    // нижняя граница номера, точная для плотных узлов
+    static size_t Locate(const Branch* branch, size_t shift, size_t& index) noexcept {
+        size_t child = std::min(index >> shift, branch->count - 1);
+        while (branch->sizes[child] <= index) {
+            ++child;
+        }
+        if (child != 0) {
+            index -= branch->sizes[child - 1];
+        }
+        return child;
+    }
+
+    static Node* CopyNode(const Node* node, size_t shift) {
+        if (shift == 0) {
+            const auto* leaf = static_cast<const Leaf*>(node);
+            auto* copy = new Leaf;
+            copy->count = leaf->count;
+            std::copy(leaf->items, leaf->items + leaf->count, copy->items);
+            return copy;
+        }
+        const auto* branch = static_cast<const Branch*>(node);
+        auto* copy = new Branch;
+        copy->count = branch->count;
+        for (size_t i = 0; i < branch->count; ++i) {
+            copy->children[i] = Retain(branch->children[i]);
+            copy->sizes[i] = branch->sizes[i];
+        }
+        return copy;
+    }
+
+    // Заменяет разделяемый узел его копией. Узел с единственной ссылкой изменяется на месте:
+    // при копировании родителя счётчики детей увеличиваются, поэтому единственная ссылка
+    // означает, что узел не виден ни из одной другой версии
+    static void MakeUnique(Node*& node, size_t shift) {
+        if (node->references.load(std::memory_order_acquire) == 1) {
+            return;
+        }
+        Node* copy = CopyNode(node, shift);
+        Release(node, shift);
+        node = copy;
+    }
+
+    static Node* NewPath(size_t shift, Type&& value) {
+        if (shift == 0) {
+            auto* leaf = new Leaf;
+            leaf->items[0] = std::move(value);
+            leaf->count = 1;
+            return leaf;
+        }
+        auto* branch = new Branch;
+        AppendChild(branch, NewPath(shift - BITS, std::move(value)), shift - BITS);
+        return branch;
+    }
+
+    static Node* Wrap(Node* node, size_t shift) {
+        auto* branch = new Branch;
+        AppendChild(branch, node, shift);
+        return branch;
+    }
+
+    void SetInPlace(size_t index, Type value) {
+        assert(index < size_);
+        Node** slot = &root_;
+        for (size_t shift = shift_; shift > 0; shift -= BITS) {
+            MakeUnique(*slot, shift);
+            auto* branch = static_cast<Branch*>(*slot);
+            slot = &branch->children[Locate(branch, shift, index)];
+        }
+        MakeUnique(*slot, 0);
+        static_cast<Leaf*>(*slot)->items[index] = std::move(value);
+    }
+
+    void PushBackInPlace(Type value) {
+        if (root_ == nullptr) {
+            root_ = NewPath(0, std::move(value));
+        } else if (!PushBackInto(root_, shift_, value)) {
+            auto* root = new Branch;
+            AppendChild(root, root_, shift_);
+            AppendChild(root, NewPath(shift_, std::move(value)), shift_);
+            root_ = root;
+            shift_ += BITS;
+        }
+        ++size_;
+    }
+
+    // Добавляет value в самое правое поддерево. Возвращает false, если оно заполнено
+    static bool PushBackInto(Node*& node, size_t shift, Type& value) {
+        if (shift == 0) {
+            if (node->count == WIDTH) {
+                return false;
+            }
+            MakeUnique(node, 0);
+            auto* leaf = static_cast<Leaf*>(node);
+            leaf->items[leaf->count++] = std::move(value);
+            return true;
+        }
+        if (IsFull(node, shift)) {
+            return false;
+        }
+        MakeUnique(node, shift);
+        auto* branch = static_cast<Branch*>(node);
+        if (PushBackInto(branch->children[branch->count - 1], shift - BITS, value)) {
+            ++branch->sizes[branch->count - 1];
+        } else {
+            AppendChild(branch, NewPath(shift - BITS, std::move(value)), shift - BITS);
+        }
+        return true;
+    }
+
+    // Сообщает, что в правую ветвь поддерева нельзя добавить элемент
+    static bool IsFull(const Node* node, size_t shift) noexcept {
+        while (shift > 0) {
+            if (node->count < WIDTH) {
+                return false;
+            }
+            node = static_cast<const Branch*>(node)->children[node->count - 1];
+            shift -= BITS;
+        }
+        return node->count == WIDTH;
+    }
+
+    // Сливает два поддерева одной высоты в один или два узла.
+    // Листья на стыке уплотняются: левый дополняется элементами правого
+    static size_t ConcatNodes(Node* left, Node* right, size_t shift, Node* out[2]) {
+        if (shift == 0) {
+            if (left->count == WIDTH) {
+                out[0] = Retain(left);
+                out[1] = Retain(right);
+                return 2;
+            }
+            const auto* lhs = static_cast<const Leaf*>(left);
+            const auto* rhs = static_cast<const Leaf*>(right);
+            const size_t total = lhs->count + rhs->count;
+            auto* first = new Leaf;
+            first->count = std::min(total, WIDTH);
+            std::copy(lhs->items, lhs->items + lhs->count, first->items);
+            const size_t moved = first->count - lhs->count;
+            std::copy(rhs->items, rhs->items + moved, first->items + lhs->count);
+            out[0] = first;
+            if (total <= WIDTH) {
+                return 1;
+            }
+            auto* second = new Leaf;
+            second->count = rhs->count - moved;
+            std::copy(rhs->items + moved, rhs->items + rhs->count, second->items);
+            out[1] = second;
+            return 2;
+        }
+
+        const auto* lhs = static_cast<const Branch*>(left);
+        const auto* rhs = static_cast<const Branch*>(right);
+        Node* seam[2];
+        const size_t seam_count =
+            ConcatNodes(lhs->children[lhs->count - 1], rhs->children[0], shift - BITS, seam);
+
+        Node* children[2 * WIDTH];
+        size_t count = 0;
+        for (size_t i = 0; i + 1 < lhs->count; ++i) {
+            children[count++] = Retain(lhs->children[i]);
+        }
+        for (size_t i = 0; i < seam_count; ++i) {
+            children[count++] = seam[i];
+        }
+        for (size_t i = 1; i < rhs->count; ++i) {
+            children[count++] = Retain(rhs->children[i]);
+        }
+
+        auto* first = new Branch;
+        for (size_t i = 0; i < std::min(count, WIDTH); ++i) {
+            AppendChild(first, children[i], shift - BITS);
+        }
+        out[0] = first;
+        if (count <= WIDTH) {
+            return 1;
+        }
+        auto* second = new Branch;
+        for (size_t i = WIDTH; i < count; ++i) {
+            AppendChild(second, children[i], shift - BITS);
+        }
+        out[1] = second;
+        return 2;
+    }
+
+    // Новое поддерево из первых count элементов node (count > 0)
+    static Node* Take(Node* node, size_t shift, size_t count) {
+        if (count == NodeSize(node, shift)) {
+            return Retain(node);
+        }
+        if (shift == 0) {
+            const auto* leaf = static_cast<const Leaf*>(node);
+            auto* result = new Leaf;
+            result->count = count;
+            std::copy(leaf->items, leaf->items + count, result->items);
+            return result;
+        }
+        const auto* branch = static_cast<const Branch*>(node);
+        size_t last = count - 1;
+        const size_t child = Locate(branch, shift, last);
+        auto* result = new Branch;
+        for (size_t i = 0; i < child; ++i) {
+            AppendChild(result, Retain(branch->children[i]), shift - BITS);
+        }
+        AppendChild(result, Take(branch->children[child], shift - BITS, last + 1), shift - BITS);
+        return result;
+    }
+
+    // Новое поддерево без первых count элементов node (count < размера node)
+    static Node* Drop(Node* node, size_t shift, size_t count) {
+        if (count == 0) {
+            return Retain(node);
+        }
+        if (shift == 0) {
+            const auto* leaf = static_cast<const Leaf*>(node);
+            auto* result = new Leaf;
+            result->count = leaf->count - count;
+            std::copy(leaf->items + count, leaf->items + leaf->count, result->items);
+            return result;
+        }
+        const auto* branch = static_cast<const Branch*>(node);
+        const size_t child = Locate(branch, shift, count);
+        auto* result = new Branch;
+        AppendChild(result, Drop(branch->children[child], shift - BITS, count), shift - BITS);
+        for (size_t i = child + 1; i < branch->count; ++i) {
+            AppendChild(result, Retain(branch->children[i]), shift - BITS);
+        }
+        return result;
+    }
+
+    // Убирает корни с единственным ребёнком
+    void Collapse() noexcept {
+        while (shift_ > 0 && root_->count == 1) {
+            Node* child = Retain(static_cast<Branch*>(root_)->children[0]);
+            Release(root_, shift_);
+            root_ = child;
+            shift_ -= BITS;
+        }
+    }
+
+    static void CopyTo(const Node* node, size_t shift, SimpleVector<Type>& out, size_t& position) {
+        if (node == nullptr) {
+            return;
+        }
+        if (shift == 0) {
+            const auto* leaf = static_cast<const Leaf*>(node);
+            std::copy(leaf->items, leaf->items + leaf->count, out.begin() + position);
+            position += leaf->count;
+            return;
+        }
+        const auto* branch = static_cast<const Branch*>(node);
+        for (size_t i = 0; i < branch->count; ++i) {
+            CopyTo(branch->children[i], shift - BITS, out, position);
+        }
+    }
+
+    Node* root_ = nullptr;
+    size_t shift_ = 0;
+    size_t size_ = 0;
+};
+
+template <typename Type>
+inline bool operator==(const ImmutableVector<Type>& lhs, const ImmutableVector<Type>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator!=(const ImmutableVector<Type>& lhs, const ImmutableVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
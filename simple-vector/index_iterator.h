@@ -0,0 +1,119 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <type_traits>
+
+// Итератор произвольного доступа для контейнеров, элементы которых лежат в памяти
+// не подряд. Хранит контейнер и индекс и обращается к элементу через operator[]
+template <typename Owner, typename Value>
+class IndexIterator {
+public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = std::remove_const_t<Value>;
+    using difference_type = std::ptrdiff_t;
+    using pointer = Value*;
+    using reference = Value&;
+
+    IndexIterator() noexcept = default;
+
+    IndexIterator(Owner* owner, size_t index) noexcept : owner_(owner), index_(index) {}
+
+    // Неконстантный итератор неявно преобразуется в константный
+    operator IndexIterator<const Owner, const Value>() const noexcept {
+        return IndexIterator<const Owner, const Value>(owner_, index_);
+    }
+
+    // Позиция элемента в контейнере
+    size_t GetIndex() const noexcept {
+        return index_;
+    }
+
+    reference operator*() const noexcept {
+        return (*owner_)[index_];
+    }
+
+    pointer operator->() const noexcept {
+        return &(*owner_)[index_];
+    }
+
+    reference operator[](difference_type offset) const noexcept {
+        return (*owner_)[index_ + offset];
+    }
+
+    IndexIterator& operator++() noexcept {
+        ++index_;
+        return *this;
+    }
+
+    IndexIterator operator++(int) noexcept {
+        auto copy = *this;
+        ++index_;
+        return copy;
+    }
+
+    IndexIterator& operator--() noexcept {
+        --index_;
+        return *this;
+    }
+
+    IndexIterator operator--(int) noexcept {
+        auto copy = *this;
+        --index_;
+        return copy;
+    }
+
+    IndexIterator& operator+=(difference_type offset) noexcept {
+        index_ += offset;
+        return *this;
+    }
+
+    IndexIterator& operator-=(difference_type offset) noexcept {
+        index_ -= offset;
+        return *this;
+    }
+
+    friend IndexIterator operator+(IndexIterator it, difference_type offset) noexcept {
+        return it += offset;
+    }
+
+    friend IndexIterator operator+(difference_type offset, IndexIterator it) noexcept {
+        return it += offset;
+    }
+
+    friend IndexIterator operator-(IndexIterator it, difference_type offset) noexcept {
+        return it -= offset;
+    }
+
+    friend difference_type operator-(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return static_cast<difference_type>(lhs.index_) - static_cast<difference_type>(rhs.index_);
+    }
+
+    friend bool operator==(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.owner_ == rhs.owner_ && lhs.index_ == rhs.index_;
+    }
+
+    friend bool operator!=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return !(lhs == rhs);
+    }
+
+    friend bool operator<(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return lhs.index_ < rhs.index_;
+    }
+
+    friend bool operator>(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return rhs < lhs;
+    }
+
+    friend bool operator<=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return !(rhs < lhs);
+    }
+
+    friend bool operator>=(const IndexIterator& lhs, const IndexIterator& rhs) noexcept {
+        return !(lhs < rhs);
+    }
+
+private:
+    Owner* owner_ = nullptr;
+    size_t index_ = 0;
+};
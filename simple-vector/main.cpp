@@ -1,9 +1,44 @@
 #include "simple_vector.h"
+#include "aligned_allocator.h"
+#include "arena.h"
+#include "circular_vector.h"
+#include "concurrent_vector.h"
+#include "cow_vector.h"
+#include "gap_vector.h"
+#include "huge_page_allocator.h"
+#include "immutable_vector.h"
+#include "mapped_vector.h"
+#include "mpmc_queue.h"
+#include "parallel_scan.h"
+#include "pool_allocator.h"
+#include "reclaimer.h"
+#include "scratch_vector.h"
+#include "segmented_vector.h"
+#include "serialization.h"
+#include "seqlock_vector.h"
+#include "snapshot_vector.h"
+#include "spsc_ring.h"
+#include "thread_pool.h"
+#include "vector_recycler.h"
+#include "vector_stream.h"
 
+#include <atomic>
 #include <cassert>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
 #include <iostream>
 #include <numeric>
+#include <sstream>
+#include <string>
+#include <thread>
 #include <utility>
+#include <vector>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
 
 using namespace std;
 
@@ -151,6 +186,1352 @@ void TestNoncopiableErase() {
     cout << "Done!" << endl << endl;
 }
 
+void TestParallelFor() {
+    const size_t size = 1000000;
+    cout << "Test parallel for" << endl;
+    SimpleVector<int> v(size);
+    ParallelFor(v, 1000, [&v](size_t first, size_t last) {
+        for (size_t i = first; i < last; ++i) {
+            v[i] = static_cast<int>(i);
+        }
+    });
+    for (size_t i = 0; i < size; ++i) {
+        assert(v[i] == static_cast<int>(i));
+    }
+
+    bool thrown = false;
+    try {
+        ParallelFor(v, 10, [](size_t first, size_t) {
+            if (first == 500) {
+                throw std::runtime_error("error");
+            }
+        });
+    } catch (const std::runtime_error&) {
+        thrown = true;
+    }
+    assert(thrown);
+
+    // Огромный grain не переполняет разбиение: весь диапазон — один блок
+    atomic<size_t> covered{0};
+    ParallelFor(v, SIZE_MAX, [&covered](size_t first, size_t last) {
+        covered += last - first;
+    });
+    assert(covered == size);
+
+    PooledSimpleVector<int> pooled(100);
+    ParallelFor(pooled, 7, [&pooled](size_t first, size_t last) {
+        fill(pooled.begin() + first, pooled.begin() + last, 1);
+    });
+    assert(accumulate(pooled.begin(), pooled.end(), 0) == 100);
+
+    // Исключение задачи, поставленной прямо в пул, сохраняется и не завершает рабочий поток
+    ThreadPool pool(2);
+    atomic<bool> ran{false};
+    pool.Submit([] {
+        throw std::runtime_error("task error");
+    });
+    pool.Submit([&ran] {
+        ran = true;
+    });
+    while (!ran) {
+        pool.TryRunPendingTask();
+    }
+    exception_ptr error;
+    for (int attempt = 0; attempt < 1000 && !error; ++attempt) {
+        error = pool.TakeError();
+        this_thread::sleep_for(1ms);
+    }
+    assert(error && !pool.TakeError());
+    cout << "Done!" << endl << endl;
+}
+
+void TestParallelReduce() {
+    const size_t size = 1000000;
+    cout << "Test parallel reduce" << endl;
+    SimpleVector<int> v = GenerateVector(size);
+    auto sum = ParallelReduce(v, 4096, uint64_t{0},
+        [&v](size_t first, size_t last) {
+            return accumulate(v.begin() + first, v.begin() + last, uint64_t{0});
+        },
+        [](uint64_t lhs, uint64_t rhs) { return lhs + rhs; });
+    assert(sum == uint64_t{size} * (size + 1) / 2);
+
+    SimpleVector<int> empty;
+    assert(ParallelReduce(empty, 16, 7, [](size_t, size_t) { return 1; }, [](int lhs, int rhs) { return lhs + rhs; }) == 7);
+
+    // Результат без конструктора по умолчанию
+    struct Count {
+        explicit Count(size_t value) : value(value) {}
+        size_t value;
+    };
+    const Count total = ParallelReduce(v, 1000, Count(0),
+        [](size_t first, size_t last) { return Count(last - first); },
+        [](Count lhs, Count rhs) { return Count(lhs.value + rhs.value); });
+    assert(total.value == size);
+    cout << "Done!" << endl << endl;
+}
+
+void TestInclusiveScan() {
+    const size_t size = 300000;
+    cout << "Test inclusive scan" << endl;
+    SimpleVector<int> v(size);
+    for (size_t i = 0; i < size; ++i) {
+        v[i] = static_cast<int>(i % 7);
+    }
+    SimpleVector<int> out;
+    InclusiveScan(v, out);
+    assert(out.GetSize() == size);
+    InclusiveScan(v);
+    assert(v == out);
+    int sum = 0;
+    for (size_t i = 0; i < size; ++i) {
+        sum += static_cast<int>(i % 7);
+        assert(v[i] == sum);
+    }
+
+    SimpleVector<uint64_t> u(size, 3);
+    InclusiveScan(u);
+    for (size_t i = 0; i < size; ++i) {
+        assert(u[i] == 3 * (i + 1));
+    }
+
+    SimpleVector<int> m{3, 1, 4, 1, 5, 9, 2, 6};
+    InclusiveScan(m, [](int lhs, int rhs) { return max(lhs, rhs); });
+    assert((m == SimpleVector<int>{3, 3, 4, 4, 5, 9, 9, 9}));
+    cout << "Done!" << endl << endl;
+}
+
+void TestExclusiveScan() {
+    const size_t size = 300000;
+    cout << "Test exclusive scan" << endl;
+    SimpleVector<uint64_t> v(size, 2);
+    SimpleVector<uint64_t> out;
+    ExclusiveScan(v, out, 10);
+    assert(out.GetSize() == size);
+    ExclusiveScan(v, 10);
+    assert(v == out);
+    for (size_t i = 0; i < size; ++i) {
+        assert(v[i] == 10 + 2 * i);
+    }
+
+    SimpleVector<int> empty;
+    ExclusiveScan(empty, 1);
+    assert(empty.IsEmpty());
+
+    // Векторы с другими распределителями, в том числе разными у входа и выхода
+    SimpleVector<uint64_t, HugePageAllocator> huge(size, 1);
+    PooledSimpleVector<uint64_t> pooled;
+    InclusiveScan(huge, pooled);
+    ExclusiveScan(huge, 0);
+    InclusiveScan(huge);
+    assert(pooled.GetSize() == size && pooled[size - 1] == size && huge[size - 1] == (size - 1) * size / 2);
+    cout << "Done!" << endl << endl;
+}
+
+void TestConcurrentPushBack() {
+    const size_t threads = 4;
+    const size_t per_thread = 100000;
+    cout << "Test concurrent push back" << endl;
+    ConcurrentSimpleVector<size_t> v;
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&v, t]() {
+            for (size_t i = 0; i < per_thread; ++i) {
+                v.PushBack(t * per_thread + i);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(v.GetSize() == threads * per_thread);
+    SimpleVector<bool> seen(threads * per_thread, false);
+    for (size_t i = 0; i < v.GetSize(); ++i) {
+        assert(!seen[v[i]]);
+        seen[v[i]] = true;
+    }
+
+    ConcurrentSimpleVector<string> strings;
+    const string* first = &strings[strings.EmplaceBack(3, 'a')];
+    for (size_t i = 0; i < 1000; ++i) {
+        strings.PushBack(to_string(i));
+    }
+    assert(first == &strings[0] && *first == "aaa");
+    assert(strings.At(1000) == "999");
+    cout << "Done!" << endl << endl;
+}
+
+void TestParallelWrite() {
+    const size_t threads = 4;
+    const size_t count = 100000;
+    cout << "Test parallel write into reserved capacity" << endl;
+    SimpleVector<size_t> v{7};
+    auto writer = v.ReserveForParallelWrite(count);
+    assert(v.GetCapacity() >= count + 1);
+    vector<thread> workers;
+    for (size_t t = 0; t < threads; ++t) {
+        workers.emplace_back([&writer]() {
+            while (true) {
+                auto range = writer.Claim(1000);
+                if (range.IsEmpty()) {
+                    break;
+                }
+                for (auto& item : range) {
+                    item = 1;
+                }
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(writer.Commit() == count + 1);
+    assert(v.GetSize() == count + 1);
+    assert(v[0] == 7);
+    assert(accumulate(v.begin(), v.end(), size_t{0}) == count + 7);
+    assert(writer.Claim(1).IsEmpty());
+
+    // Огромный count не переполняет курсор и не выдаёт пересекающиеся диапазоны
+    SimpleVector<int> small;
+    auto small_writer = small.ReserveForParallelWrite(10);
+    auto head = small_writer.Claim(3);
+    auto rest = small_writer.Claim(SIZE_MAX);
+    assert(head.GetSize() == 3 && rest.begin() == head.end() && rest.GetSize() == 7);
+    assert(small_writer.Claim(SIZE_MAX).IsEmpty() && small_writer.Claim(1).IsEmpty());
+    assert(small_writer.Commit() == 10);
+
+    // size + count, не помещающийся в size_t, отклоняется до резервирования
+    try {
+        small.ReserveForParallelWrite(SIZE_MAX - 5);
+        assert(false);
+    } catch (const length_error&) {
+        assert(small.GetSize() == 10 && small.GetCapacity() == 10);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestSnapshotVector() {
+    const size_t readers = 3;
+    const int updates = 200;
+    cout << "Test snapshot vector" << endl;
+    SnapshotVector<int> v(SimpleVector<int>(100, 0));
+    atomic<bool> stop{false};
+    vector<thread> workers;
+    for (size_t t = 0; t < readers; ++t) {
+        workers.emplace_back([&v, &stop]() {
+            int last_seen = 0;
+            while (!stop.load()) {
+                auto snapshot = v.Read();
+                assert(snapshot.GetSize() == 100);
+                const int version = snapshot[0];
+                for (int item : snapshot) {
+                    assert(item == version);
+                }
+                assert(version >= last_seen);
+                last_seen = version;
+            }
+        });
+    }
+    for (int version = 1; version <= updates; ++version) {
+        v.Update([version](SimpleVector<int>& items) {
+            fill(items.begin(), items.end(), version);
+        });
+    }
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(v.Read()[99] == updates);
+
+    v.Store(SimpleVector<int>{1, 2, 3});
+    assert((v.Load() == SimpleVector<int>{1, 2, 3}));
+    cout << "Done!" << endl << endl;
+}
+
+void TestSeqlockVector() {
+    const size_t size = 64;
+    const int updates = 20000;
+    cout << "Test seqlock vector" << endl;
+    SeqlockVector<double> v(size, 0.0);
+    atomic<bool> stop{false};
+    vector<thread> workers;
+    for (size_t t = 0; t < 3; ++t) {
+        workers.emplace_back([&v, &stop]() {
+            SimpleVector<double> snapshot;
+            while (!stop.load()) {
+                v.ReadInto(snapshot);
+                assert(snapshot.GetSize() == size);
+                for (double item : snapshot) {
+                    assert(item == snapshot[0]);
+                }
+            }
+        });
+    }
+    SimpleVector<double> values(size);
+    for (int version = 1; version <= updates; ++version) {
+        fill(values.begin(), values.end(), version);
+        v.Store(values);
+    }
+    stop = true;
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    v.Store(3, 0.5);
+    assert(v.Load(3) == 0.5);
+    assert(v.Load(4) == updates);
+    cout << "Done!" << endl << endl;
+}
+
+void TestSpscRing() {
+    const size_t count = 1000000;
+    cout << "Test SPSC ring" << endl;
+    SpscRing<size_t> ring(1000);
+    assert(ring.GetCapacity() == 1024);
+    thread producer([&ring]() {
+        size_t batch[64];
+        size_t next = 0;
+        while (next < count) {
+            const size_t batch_size = min<size_t>(64, count - next);
+            iota(batch, batch + batch_size, next);
+            next += ring.PushN(batch, batch_size);
+        }
+    });
+    size_t expected = 0;
+    size_t batch[100];
+    while (expected < count) {
+        const size_t popped = ring.PopN(batch, 100);
+        for (size_t i = 0; i < popped; ++i) {
+            assert(batch[i] == expected++);
+        }
+    }
+    producer.join();
+    assert(ring.IsEmpty());
+
+    SpscRing<X> moves(2);
+    assert(moves.TryPush(X(1)) && moves.TryPush(X(2)) && !moves.TryPush(X(3)));
+    X item;
+    assert(moves.TryPop(item) && item.GetX() == 1);
+    cout << "Done!" << endl << endl;
+}
+
+void TestMpmcQueue() {
+    const size_t producers = 3;
+    const size_t consumers = 3;
+    const size_t per_producer = 50000;
+    cout << "Test MPMC queue" << endl;
+    MpmcQueue<size_t> queue(128);
+    atomic<size_t> sum{0};
+    vector<thread> workers;
+    for (size_t p = 0; p < producers; ++p) {
+        workers.emplace_back([&queue]() {
+            for (size_t i = 1; i <= per_producer; ++i) {
+                queue.Push(i);
+            }
+        });
+    }
+    for (size_t c = 0; c < consumers; ++c) {
+        workers.emplace_back([&queue, &sum]() {
+            for (size_t i = 0; i < per_producer; ++i) {
+                sum += queue.Pop();
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(sum == producers * per_producer * (per_producer + 1) / 2);
+
+    size_t item = 0;
+    assert(!queue.TryPop(item));
+    for (size_t i = 0; i < queue.GetCapacity(); ++i) {
+        assert(queue.TryPush(i));
+    }
+    assert(!queue.TryPush(0));
+    assert(queue.TryPop(item) && item == 0);
+
+    // Очередь на один элемент не затирает непрочитанное значение
+    MpmcQueue<size_t> single(1);
+    assert(single.TryPush(1));
+    single.TryPush(2);
+    assert(single.TryPop(item) && item == 1);
+    cout << "Done!" << endl << endl;
+}
+
+void TestCircularVector() {
+    cout << "Test circular vector" << endl;
+    CircularVector<int> v;
+    for (int i = 0; i < 10; ++i) {
+        v.PushBack(i);
+        v.PushFront(-i - 1);
+    }
+    assert(v.GetSize() == 20);
+    for (int i = 0; i < 20; ++i) {
+        assert(v[i] == i - 10);
+    }
+    v.PopFront();
+    v.PopBack();
+    assert(v.Front() == -9 && v.Back() == 8);
+    v.Insert(v.begin() + 2, 100);
+    v.Insert(v.end() - 2, 200);
+    assert(v[2] == 100 && v[v.GetSize() - 3] == 200);
+    v.Erase(v.begin() + 2);
+    v.Erase(v.end() - 3);
+    assert(v.GetSize() == 18);
+    assert(is_sorted(v.begin(), v.end()));
+    assert(*min_element(v.cbegin(), v.cend()) == -9);
+
+    CircularVector<X> moves;
+    moves.PushBack(X(1));
+    moves.PushFront(X(2));
+    assert(moves.begin()->GetX() == 2);
+    cout << "Done!" << endl << endl;
+}
+
+void TestCircularVectorWindow() {
+    cout << "Test circular vector sliding window" << endl;
+    CircularVector<int> window(Reserve(4), OverflowPolicy::OVERWRITE_OLDEST);
+    for (int i = 0; i < 10; ++i) {
+        window.PushBack(i);
+    }
+    assert(window.GetCapacity() == 4);
+    assert((window == CircularVector<int>{6, 7, 8, 9}));
+
+    auto spans = window.AsSpans();
+    assert(spans.first.GetSize() + spans.second.GetSize() == 4);
+    assert(!spans.second.IsEmpty());
+    int sum = 0;
+    for (int item : spans.first) {
+        sum += item;
+    }
+    for (int item : spans.second) {
+        sum += item;
+    }
+    assert(sum == 6 + 7 + 8 + 9);
+
+    CircularVector<int> copy(window);
+    copy.PushBack(10);
+    assert((copy == CircularVector<int>{7, 8, 9, 10}));
+    window.PushFront(5);
+    assert((window == CircularVector<int>{5, 6, 7, 8}));
+    cout << "Done!" << endl << endl;
+}
+
+void TestGapVector() {
+    cout << "Test gap vector" << endl;
+    GapVector<char> text;
+    for (char c : string("hello world")) {
+        text.PushBack(c);
+    }
+    // Правки вокруг курсора после "hello"
+    auto cursor = text.begin() + 5;
+    cursor = text.Insert(cursor, ',') + 1;
+    assert(text.GetGapPosition() == 6);
+    text.Insert(cursor, '!');
+    text.Erase(text.begin() + 6);
+    text.Erase(text.end() - 1);
+    text.Insert(text.begin(), '>');
+    assert(string(text.begin(), text.end()) == ">hello, worl");
+    assert(text.At(1) == 'h');
+
+    text.Resize(4);
+    text.Resize(6);
+    assert(text.GetSize() == 6 && text[5] == '\0');
+
+    SimpleVector<char> compact = text.Compact();
+    assert(compact.GetSize() == 6 && compact[0] == '>');
+    assert(text.IsEmpty());
+
+    GapVector<X> moves;
+    moves.PushBack(X(1));
+    moves.Insert(moves.begin(), X(2));
+    moves.Insert(moves.end(), X(3));
+    assert(moves[0].GetX() == 2 && moves[1].GetX() == 1 && moves[2].GetX() == 3);
+    cout << "Done!" << endl << endl;
+}
+
+void TestSegmentedVector() {
+    const size_t size = 100000;
+    cout << "Test segmented vector" << endl;
+    SegmentedVector<size_t> v;
+    v.PushBack(0);
+    const size_t* first = &v[0];
+    for (size_t i = 1; i < size; ++i) {
+        v.PushBack(i);
+    }
+    assert(first == &v[0]);
+    assert(v.GetSize() == size && v.GetCapacity() >= size);
+    for (size_t i = 0; i < size; ++i) {
+        assert(v[i] == i);
+    }
+    assert(equal(v.begin(), v.end(), v.cbegin()));
+    assert(accumulate(v.begin(), v.end(), size_t{0}) == size * (size - 1) / 2);
+
+    SegmentedVector<size_t> copy(v);
+    assert(copy == v);
+    copy.Resize(10);
+    copy.Resize(20);
+    assert(copy[9] == 9 && copy[10] == 0);
+    assert(copy < v);
+
+    SegmentedVector<X> moves;
+    for (size_t i = 0; i < 100; ++i) {
+        moves.PushBack(X(i));
+    }
+    assert(moves.At(99).GetX() == 99);
+    cout << "Done!" << endl << endl;
+}
+
+void TestCowVector() {
+    const size_t size = 1000;
+    cout << "Test copy-on-write vector" << endl;
+    CowVector<int> original(GenerateVector(size));
+    CowVector<int> copy = original;
+    assert(original.IsShared() && copy.IsShared());
+    assert(copy.cbegin() == original.cbegin());
+
+    copy[0] = -1;
+    assert(!original.IsShared() && !copy.IsShared());
+    assert(copy.cbegin() != original.cbegin());
+    assert(original[0] == 1 && copy[0] == -1);
+
+    CowVector<int> inserted = original;
+    inserted.Insert(inserted.cbegin() + 1, 100);
+    inserted.Erase(inserted.cbegin());
+    assert(inserted[0] == 100 && inserted.GetSize() == size);
+    assert(original[0] == 1 && original.GetSize() == size);
+
+    vector<thread> workers;
+    for (size_t t = 0; t < 4; ++t) {
+        workers.emplace_back([original]() {
+            for (int i = 0; i < 1000; ++i) {
+                CowVector<int> local = original;
+                assert(local.GetSize() == size);
+            }
+            CowVector<int> changed = original;
+            changed.PushBack(0);
+            assert(changed.GetSize() == size + 1);
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    assert(!original.IsShared());
+    assert(original.GetSize() == size);
+
+    // После выдачи изменяемой ссылки копия получает собственный буфер
+    CowVector<int> owner{1, 2, 3};
+    int& first = owner[0];
+    CowVector<int> snapshot = owner;
+    assert(!owner.IsShared() && !snapshot.IsShared());
+    first = 42;
+    assert(snapshot.Get()[0] == 1 && owner.Get()[0] == 42);
+    CowVector<int> snapshot_copy = snapshot;
+    assert(snapshot.IsShared() && snapshot_copy.cbegin() == snapshot.cbegin());
+    // После перевыделения памяти прежние ссылки недействительны, и копии снова разделяют буфер
+    owner.Reserve(100);
+    CowVector<int> shared_again = owner;
+    assert(owner.IsShared() && shared_again.cbegin() == owner.cbegin());
+    // Вставка возвращает изменяемый итератор на новый буфер
+    CowVector<int> inserting{1, 2, 3};
+    auto position = inserting.Insert(inserting.cbegin(), 0);
+    CowVector<int> inserted_copy = inserting;
+    *position = 5;
+    assert(!inserting.IsShared() && inserted_copy.Get()[0] == 0 && inserting.Get()[0] == 5);
+
+    CowVector<int> empty;
+    assert(empty.begin() == nullptr && empty.end() == nullptr);
+    assert(empty.IsEmpty() && empty.begin() == empty.end());
+    empty.PushBack(1);
+    assert(empty.At(0) == 1);
+    cout << "Done!" << endl << endl;
+}
+
+void TestImmutableVector() {
+    const size_t size = 5000;
+    cout << "Test immutable vector" << endl;
+    ImmutableVector<int> empty;
+    ImmutableVector<int> v = empty;
+    for (size_t i = 0; i < size; ++i) {
+        v = v.PushBack(static_cast<int>(i));
+    }
+    assert(empty.IsEmpty() && v.GetSize() == size);
+    SimpleVector<int> items = v.ToSimpleVector();
+    for (size_t i = 0; i < size; ++i) {
+        assert(v[i] == static_cast<int>(i) && items[i] == v[i]);
+    }
+    assert(ImmutableVector<int>::FromSimpleVector(items) == v);
+
+    auto changed = v.Set(1234, -1);
+    assert(v[1234] == 1234 && changed[1234] == -1);
+
+    auto slice = v.Slice(100, 4000);
+    assert(slice.GetSize() == 3900 && slice[0] == 100 && slice[3899] == 3999);
+    auto joined = slice.Concat(v.Slice(0, 100)).Concat(v.Slice(4000, size));
+    assert(joined.GetSize() == size);
+    assert(joined[3899] == 3999 && joined[3900] == 0 && joined[4000] == 4000);
+
+    // Много мелких конкатенаций и срезов сравниваются с последовательной сборкой
+    ImmutableVector<int> pieces;
+    SimpleVector<int> expected;
+    for (int i = 0; i < 300; ++i) {
+        ImmutableVector<int> piece;
+        for (int j = 0; j < i % 40; ++j) {
+            piece = piece.PushBack(i * 100 + j);
+            expected.PushBack(i * 100 + j);
+        }
+        pieces = pieces.Concat(piece);
+    }
+    assert(pieces.ToSimpleVector() == expected);
+    auto middle = pieces.Slice(17, 3000);
+    for (size_t i = 0; i < middle.GetSize(); ++i) {
+        assert(middle[i] == expected[i + 17]);
+    }
+
+    auto transient = middle.ToTransient();
+    for (int i = 0; i < 1000; ++i) {
+        transient.PushBack(i);
+    }
+    transient.Set(0, -5);
+    auto batch = move(transient).Persistent();
+    assert(batch.GetSize() == middle.GetSize() + 1000);
+    assert(batch[0] == -5 && middle[0] == expected[17]);
+    assert(batch[batch.GetSize() - 1] == 999);
+    cout << "Done!" << endl << endl;
+}
+
+void TestMappedVector() {
+    const size_t size = 100000;
+    cout << "Test mapped vector" << endl;
+    const string path = (filesystem::temp_directory_path() / "simple_vector_mapped_test.bin").string();
+    remove(path.c_str());
+    {
+        MappedVector<uint64_t> v(path, MapMode::READ_WRITE);
+        assert(v.IsEmpty() && v.begin() == v.end());
+        for (size_t i = 0; i < size; ++i) {
+            v.PushBack(i * i);
+        }
+        assert(v.GetSize() == size && v.GetCapacity() >= size);
+        v[7] = 42;
+        v.Flush();
+    }
+    assert(filesystem::file_size(path) == size * sizeof(uint64_t));
+    {
+        const MappedVector<uint64_t> v(path);
+        assert(v.GetSize() == size && v[7] == 42 && v.At(size - 1) == (size - 1) * (size - 1));
+        size_t index = 0;
+        for (uint64_t value : v) {
+            assert(value == (index == 7 ? 42 : index * index));
+            ++index;
+        }
+        try {
+            v.At(size);
+            assert(false);
+        } catch (const out_of_range&) {
+        }
+    }
+    {
+        MappedVector<uint64_t> v(path, MapMode::READ_WRITE);
+        v.Resize(size + 10);
+        assert(v[size - 1] == (size - 1) * (size - 1) && v[size + 9] == 0);
+        v.Resize(3);
+    }
+    assert(filesystem::file_size(path) == 3 * sizeof(uint64_t));
+    {
+        MappedVector<uint64_t> v(path);
+        try {
+            v.PushBack(1);
+            assert(false);
+        } catch (const logic_error&) {
+        }
+    }
+    remove(path.c_str());
+    try {
+        MappedVector<uint64_t> missing(path);
+        assert(false);
+    } catch (const system_error&) {
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestSerialization() {
+    const size_t size = 50000;
+    cout << "Test serialization" << endl;
+    const string path = (filesystem::temp_directory_path() / "simple_vector_serialization_test.bin").string();
+    SimpleVector<double> items(size);
+    for (size_t i = 0; i < size; ++i) {
+        items[i] = static_cast<double>(i) / 3;
+    }
+
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    Save(fd, items);
+    Save(fd, SimpleVector<double>());
+    assert(filesystem::file_size(path) == SerializedSize<double>(size) + SerializedSize<double>(0));
+    lseek(fd, 0, SEEK_SET);
+    assert(Load<double>(fd) == items);
+    assert(Load<double>(fd).IsEmpty());
+    try {
+        Load<double>(fd);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    lseek(fd, 0, SEEK_SET);
+    try {
+        Load<float>(fd);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    lseek(fd, 0, SEEK_SET);
+    try {
+        Load<double>(fd, size - 1);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    close(fd);
+
+    // Количество элементов из испорченного заголовка не приводит к выделению памяти впрок
+    unsigned char hostile[SerializedSize<double>(0)];
+    {
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        Save(pipe_fds[1], SimpleVector<double>(3, 1.0));
+        assert(read(pipe_fds[0], hostile, sizeof(hostile)) == static_cast<ssize_t>(sizeof(hostile)));
+        const uint64_t huge_count = uint64_t(1) << 40;
+        memcpy(hostile + offsetof(serialization_detail::Header, count), &huge_count, sizeof(huge_count));
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(write(fd, hostile, sizeof(hostile)) == static_cast<ssize_t>(sizeof(hostile)));
+    lseek(fd, 0, SEEK_SET);
+    try {
+        Load<double>(fd);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    close(fd);
+    {
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        assert(write(pipe_fds[1], hostile, sizeof(hostile)) == static_cast<ssize_t>(sizeof(hostile)));
+        close(pipe_fds[1]);
+        try {
+            Load<double>(pipe_fds[0]);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+        close(pipe_fds[0]);
+    }
+
+    // Векторы с другим распределителем
+    {
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        PooledSimpleVector<int> pooled{1, 2, 3};
+        Save(pipe_fds[1], pooled);
+        close(pipe_fds[1]);
+        assert((Load<int, PoolAllocator>(pipe_fds[0]) == pooled));
+        close(pipe_fds[0]);
+    }
+
+    fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    Save(fd, items);
+    close(fd);
+
+    {
+        // Файл отображается в память и читается на месте
+        const MappedVector<unsigned char> bytes(path);
+        VectorView<double> view(bytes.begin(), bytes.GetSize());
+        assert(view.GetSize() == size);
+        assert(equal(view.begin(), view.end(), items.begin(), items.end()));
+        assert(view.At(size - 1) == items[size - 1]);
+        try {
+            VectorView<double>(bytes.begin(), SerializedSize<double>(size) - 1);
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+    }
+    remove(path.c_str());
+
+    unsigned char garbage[SerializedSize<int>(0)] = {};
+    memcpy(garbage, "SVEX", 4);
+    try {
+        VectorView<int>(garbage, sizeof(garbage));
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestVectorStream() {
+    const size_t size = 100000;
+    const size_t chunk_size = 4096;
+    cout << "Test vector stream" << endl;
+    SimpleVector<int> items(size);
+    iota(items.begin(), items.end(), 0);
+
+    for (PrefetchMode mode : {PrefetchMode::SYNC, PrefetchMode::BACKGROUND}) {
+        stringstream stream;
+        {
+            VectorWriter<int> writer(stream, chunk_size);
+            writer.Write(items.begin(), 10);
+            writer.Write(items.begin() + 10, size - 11);
+            writer.Write(items[size - 1]);
+        }
+        VectorReader<int> reader(stream, mode);
+        assert(reader.GetChunkSize() == chunk_size);
+        SimpleVector<int> chunk;
+        size_t offset = 0;
+        while (reader.ReadChunk(chunk)) {
+            assert(chunk.GetSize() <= chunk_size);
+            for (size_t i = 0; i < chunk.GetSize(); ++i) {
+                assert(chunk[i] == items[offset + i]);
+            }
+            offset += chunk.GetSize();
+        }
+        assert(offset == size && chunk.IsEmpty() && !reader.ReadChunk(chunk));
+
+        // Порча одного байта обнаруживается контрольной суммой блока
+        string bytes = stream.str();
+        bytes[bytes.size() / 2] ^= 1;
+        stringstream corrupted(bytes);
+        VectorReader<int> bad_reader(corrupted, mode);
+        try {
+            bad_reader.ReadAll();
+            assert(false);
+        } catch (const runtime_error&) {
+        }
+    }
+
+    const string path = (filesystem::temp_directory_path() / "simple_vector_stream_test.bin").string();
+    int fd = open(path.c_str(), O_RDWR | O_CREAT | O_TRUNC, 0644);
+    assert(fd >= 0);
+    {
+        VectorWriter<int> writer(fd, chunk_size);
+        writer.Write(items);
+        writer.Finish();
+    }
+    lseek(fd, 0, SEEK_SET);
+    {
+        VectorReader<int> reader(fd);
+        assert(reader.ReadAll() == items);
+    }
+    lseek(fd, 0, SEEK_SET);
+    {
+        // Читатель, брошенный на середине, останавливает фоновый поток
+        VectorReader<int> reader(fd);
+        SimpleVector<int> chunk;
+        assert(reader.ReadChunk(chunk) && chunk[0] == 0);
+    }
+    close(fd);
+    remove(path.c_str());
+
+    {
+        // Деструктор прерывает фоновое чтение из канала, в который больше ничего не пишут
+        int pipe_fds[2];
+        assert(pipe(pipe_fds) == 0);
+        {
+            VectorWriter<int> writer(pipe_fds[1], 16);
+            writer.Write(items.begin(), 16);
+            VectorReader<int> reader(pipe_fds[0]);
+            SimpleVector<int> chunk;
+            assert(reader.ReadChunk(chunk) && chunk.GetSize() == 16 && chunk[15] == 15);
+        }
+        close(pipe_fds[0]);
+        close(pipe_fds[1]);
+    }
+
+    // Длина блока из испорченного заголовка ограничена
+    stringstream hostile;
+    {
+        VectorWriter<int> writer(hostile, 16);
+    }
+    string bytes = hostile.str();
+    const uint64_t huge_chunk = uint64_t(1) << 40;
+    memcpy(bytes.data() + offsetof(stream_detail::StreamHeader, chunk_size), &huge_chunk, sizeof(huge_chunk));
+    stringstream corrupted(bytes);
+    try {
+        VectorReader<int> reader(corrupted);
+        assert(false);
+    } catch (const runtime_error&) {
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestHugePageAllocator() {
+    const size_t size = 1 << 20;
+    cout << "Test huge page allocator" << endl;
+    SimpleVector<uint64_t, HugePageAllocator> table(size);
+    assert(reinterpret_cast<uintptr_t>(table.begin()) % HugePageAllocator::HUGE_PAGE_SIZE == 0);
+    assert(all_of(table.begin(), table.end(), [](uint64_t value) {
+        return value == 0;
+    }));
+    iota(table.begin(), table.end(), uint64_t{0});
+    table.PushBack(size);
+    assert(table.GetSize() == size + 1 && table[size] == size && table[size / 2] == size / 2);
+    assert(reinterpret_cast<uintptr_t>(table.begin()) % HugePageAllocator::HUGE_PAGE_SIZE == 0);
+
+    // Маленькие векторы остаются в куче
+    SimpleVector<uint64_t, HugePageAllocator> small(10, 7);
+    assert(!HugePageAllocator::IsMapped(small.GetCapacity() * sizeof(uint64_t)));
+    small = SimpleVector<uint64_t, HugePageAllocator>{1, 2, 3};
+    assert(small.GetSize() == 3 && small[2] == 3);
+
+    // Нетривиальные элементы конструируются и разрушаются в отображении
+    SimpleVector<string, HugePageAllocator> names(size / 8);
+    names[0] = string(100, 'x');
+    names.PushBack("last");
+    assert(names[0].size() == 100 && names[size / 8] == "last" && names[1].empty());
+    cout << "Done!" << endl << endl;
+}
+
+void TestHugePageGrowth() {
+    const size_t size = 1 << 19;
+    cout << "Test huge page growth" << endl;
+    ArrayPtr<uint64_t, HugePageAllocator> items(size);
+    iota(items.Get(), items.Get() + size, uint64_t{0});
+    assert(items.TryExtend(size * 4) && items.GetSize() == size * 4);
+    assert(reinterpret_cast<uintptr_t>(items.Get()) % HugePageAllocator::HUGE_PAGE_SIZE == 0);
+    assert(items[size - 1] == size - 1 && items[size] == 0 && items[size * 4 - 1] == 0);
+
+    // Без поддержки распределителя или для нетривиальных типов массив не изменяется
+    ArrayPtr<uint64_t> heap(size);
+    assert(!heap.TryExtend(size * 2) && heap.GetSize() == size);
+    ArrayPtr<string, HugePageAllocator> names(size);
+    assert(!names.TryExtend(size * 2) && names.GetSize() == size);
+
+    SimpleVector<uint64_t, HugePageAllocator> table;
+    for (uint64_t i = 0; i < size * 4; ++i) {
+        table.PushBack(i);
+    }
+    table.Reserve(table.GetCapacity() + 1);
+    table.Resize(size * 4 + 10);
+    assert(table.GetCapacity() > size * 4 && table[size * 4 + 9] == 0);
+    for (uint64_t i = 0; i < size * 4; ++i) {
+        assert(table[i] == i);
+    }
+    cout << "Done!" << endl << endl;
+}
+
+void TestAlignedSimpleVector() {
+    cout << "Test aligned simple vector" << endl;
+    AlignedSimpleVector<float> values(10, 1.5f);
+    assert(reinterpret_cast<uintptr_t>(values.begin()) % 64 == 0);
+    for (int i = 0; i < 1000; ++i) {
+        values.PushBack(static_cast<float>(i));
+        assert(reinterpret_cast<uintptr_t>(values.begin()) % 64 == 0);
+    }
+    assert(values.GetSize() == 1010 && values[9] == 1.5f && values[1009] == 999.0f);
+
+    AlignedSimpleVector<double, 4096> pages(3);
+    assert(reinterpret_cast<uintptr_t>(pages.begin()) % 4096 == 0 && pages[2] == 0.0);
+
+    // Хвост до границы выравнивания можно читать целым регистром
+    using Padded = AlignedAllocator<64, true>;
+    static_assert(Padded::PaddedSize<float>(17) == 32 && Padded::PaddedSize<float>(16) == 16);
+    AlignedSimpleVector<float, 64, true> padded(17, 2.0f);
+    const float* data = padded.begin();
+    float sum = 0;
+    for (size_t i = 0; i < Padded::PaddedSize<float>(padded.GetSize()); ++i) {
+        sum += data[i];
+    }
+    assert(sum == 34.0f);
+
+    AlignedSimpleVector<string, 64, true> names(3);
+    names.PushBack(string(50, 'a'));
+    assert(names[3].size() == 50 && names == (AlignedSimpleVector<string, 64, true>{"", "", "", string(50, 'a')}));
+    cout << "Done!" << endl << endl;
+}
+
+// Доля резидентных страниц буфера, выровненного на страницу
+double ResidentShare(const void* data, size_t bytes) {
+    const size_t page_size = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t pages = (bytes + page_size - 1) / page_size;
+    vector<unsigned char> status(pages);
+    assert(mincore(const_cast<void*>(data), bytes, status.data()) == 0);
+    return static_cast<double>(count_if(status.begin(), status.end(), [](unsigned char page) {
+               return page & 1;
+           })) / static_cast<double>(pages);
+}
+
+void TestPrefault() {
+    const size_t size = 1 << 21;
+    const size_t bytes = size * sizeof(uint64_t);
+    cout << "Test prefault" << endl;
+    {
+        SimpleVector<uint64_t, HugePageAllocator> lazy(Reserve(size / 2));
+        assert(ResidentShare(lazy.begin(), bytes / 2) < 0.5);
+        // Вместимость не меняется — страницы не подгружаются
+        lazy.Reserve(Reserve(size / 2, PrefaultPolicy::POPULATE));
+        assert(ResidentShare(lazy.begin(), bytes / 2) < 0.5);
+        lazy.Reserve(Reserve(size, PrefaultPolicy::POPULATE));
+        assert(lazy.GetCapacity() == size && ResidentShare(lazy.begin() + size / 2, bytes / 2) == 1.0);
+    }
+    {
+        // Пустой вектор получает новый буфер, который тоже не заполняется заранее
+        SimpleVector<uint64_t, HugePageAllocator> empty;
+        empty.Reserve(Reserve(size, PrefaultPolicy::NONE));
+        assert(empty.GetCapacity() == size && ResidentShare(empty.begin(), bytes) < 0.5);
+        empty.PushBack(7);
+        empty.Reserve(Reserve(2 * size, PrefaultPolicy::NONE));
+        assert(empty[0] == 7 && ResidentShare(empty.begin() + size, bytes) < 0.5);
+    }
+    {
+        SimpleVector<uint64_t, HugePageAllocator> eager(Reserve(size, PrefaultPolicy::POPULATE));
+        assert(eager.IsEmpty() && ResidentShare(eager.begin(), bytes) == 1.0);
+    }
+    {
+        SimpleVector<uint64_t, HugePageAllocator> target(Reserve(size));
+        PrefaultJob job = Prefault(target.begin(), bytes, PrefaultPolicy::BACKGROUND);
+        job.Wait();
+        // Без MADV_POPULATE_WRITE фоновая подгрузка ничего не делает
+        assert(!prefault_detail::PopulateWriteSupported() || ResidentShare(target.begin(), bytes) == 1.0);
+    }
+    // Фоновая подгрузка останавливается раньше, чем буфер освобождается или переносится
+    for (int i = 0; i < 20; ++i) {
+        SimpleVector<uint64_t, HugePageAllocator> background(Reserve(size, PrefaultPolicy::BACKGROUND));
+        if (i % 2 == 0) {
+            background.Resize(size + 1);
+            assert(background[size] == 0);
+        }
+        SimpleVector<uint64_t, HugePageAllocator> other;
+        other.swap(background);
+        other.Reserve(Reserve(2 * size, PrefaultPolicy::BACKGROUND));
+    }
+    SimpleVector<int> small(Reserve(3, PrefaultPolicy::POPULATE));
+    small.PushBack(1);
+    assert(small.GetCapacity() == 3 && small[0] == 1);
+    cout << "Done!" << endl << endl;
+}
+
+atomic<size_t> released_buffers{0};
+
+void CountRelease(void* data, size_t) {
+    delete[] static_cast<char*>(data);
+    released_buffers.fetch_add(1);
+}
+
+void TestDeferredFree() {
+    const size_t size = 1 << 18;
+    cout << "Test deferred free" << endl;
+    {
+        // Короткая очередь: при заполнении буфер освобождается в вызывающем потоке
+        Reclaimer reclaimer(2);
+        for (int i = 0; i < 100; ++i) {
+            reclaimer.Submit(CountRelease, new char[16], 16);
+        }
+        reclaimer.Drain();
+        assert(reclaimer.GetPending() == 0 && released_buffers == 100);
+
+        // Drain, ожидающий одновременно с Submit в заполненную очередь, просыпается
+        thread producer([&reclaimer] {
+            for (int i = 0; i < 10000; ++i) {
+                reclaimer.Submit(CountRelease, new char[16], 16);
+            }
+        });
+        for (int i = 0; i < 1000; ++i) {
+            reclaimer.Drain();
+        }
+        producer.join();
+        reclaimer.Drain();
+        assert(released_buffers == 10100);
+
+        // Несколько потоков одновременно кладут буферы, часть освобождается в вызывающих потоках
+        vector<thread> producers;
+        for (int t = 0; t < 4; ++t) {
+            producers.emplace_back([&reclaimer] {
+                for (int i = 0; i < 2000; ++i) {
+                    reclaimer.Submit(CountRelease, new char[16], 16);
+                }
+            });
+        }
+        for (auto& worker : producers) {
+            worker.join();
+        }
+        reclaimer.Drain();
+        assert(reclaimer.GetPending() == 0 && released_buffers == 18100);
+    }
+    {
+        using Allocator = DeferredFreeAllocator<HugePageAllocator>;
+        vector<SimpleVector<uint64_t, Allocator>> tables;
+        for (int i = 0; i < 8; ++i) {
+            tables.emplace_back(size, static_cast<uint64_t>(i));
+        }
+        tables[3].PushBack(1);
+        assert(tables[3][size] == 1 && tables[7][size - 1] == 7);
+        tables.clear();
+        SimpleVector<uint64_t, Allocator> small(10, 1);
+        SimpleVector<string, Allocator> names(size, "name");
+    }
+    Reclaimer::Instance().Drain();
+    assert(Reclaimer::Instance().GetPending() == 0);
+    cout << "Done!" << endl << endl;
+}
+
+// Время, за которое 8 потоков наращивают векторы через Allocator: каждое удвоение
+// выделяет буфер нового класса размеров, которого ещё нет ни в одном кэше
+template <typename Allocator>
+chrono::milliseconds GrowthPhaseTime() {
+    const auto start = chrono::steady_clock::now();
+    vector<thread> workers;
+    for (int t = 0; t < 8; ++t) {
+        workers.emplace_back([] {
+            for (int round = 0; round < 200; ++round) {
+                vector<SimpleVector<int, Allocator>> items(16);
+                for (int i = 0; i < 4096; ++i) {
+                    for (auto& item : items) {
+                        item.PushBack(i);
+                    }
+                }
+                assert(items[15][4095] == 4095);
+            }
+        });
+    }
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    return chrono::duration_cast<chrono::milliseconds>(chrono::steady_clock::now() - start);
+}
+
+void TestPoolAllocator() {
+    cout << "Test pool allocator" << endl;
+    const size_t bytes = 100 * sizeof(int);
+    const int* first_buffer = nullptr;
+    {
+        PooledSimpleVector<int> items(100, 1);
+        first_buffer = items.begin();
+    }
+    const size_t cached = BufferPool::GetCachedCount(bytes);
+    assert(cached >= 1);
+    {
+        // Буфер того же класса снимается с кэша потока
+        PooledSimpleVector<int> items(120);
+        assert(items.begin() == first_buffer && items[119] == 0);
+        assert(BufferPool::GetCachedCount(bytes) == cached - 1);
+        for (int i = 0; i < 1000; ++i) {
+            items.PushBack(i);
+        }
+        assert(items[1119] == 999);
+    }
+
+    {
+        BufferPool::ScopedLimits limits(4, 6);
+        {
+            vector<PooledArrayPtr<char>> buffers;
+            for (int i = 0; i < 20; ++i) {
+                buffers.emplace_back(1000);
+            }
+        }
+        assert(BufferPool::GetCachedCount(1000) <= 4 && BufferPool::GetDepotCount(1000) <= 6);
+    }
+    {
+        // После выхода из области действуют прежние лимиты
+        vector<PooledArrayPtr<char>> buffers;
+        for (int i = 0; i < 20; ++i) {
+            buffers.emplace_back(5000);
+        }
+    }
+    assert(BufferPool::GetCachedCount(5000) > 4);
+
+    // Кэш завершившегося потока переходит в общее хранилище и достаётся другим потокам
+    const size_t depot_before = BufferPool::GetDepotCount(3000);
+    thread([] {
+        PooledArrayPtr<char> a(3000), b(3000);
+    }).join();
+    assert(BufferPool::GetDepotCount(3000) == depot_before + 2);
+    PooledSimpleVector<string> names(3, "name");
+    names.PushBack("last");
+    assert(names[3] == "last" && BufferPool::GetDepotCount(3000) == depot_before + 2);
+    vector<PooledArrayPtr<char>> reused;
+    while (BufferPool::GetCachedCount(3000) != 0) {
+        reused.emplace_back(2500);
+    }
+    reused.emplace_back(2500);
+    assert(BufferPool::GetDepotCount(3000) < depot_before + 2);
+
+    // Фаза роста в нескольких потоках: кэши пусты, и промахи не должны упираться в мьютекс хранилища
+    const auto pooled = GrowthPhaseTime<PoolAllocator>();
+    const auto baseline = GrowthPhaseTime<NewDeleteAllocator>();
+    cout << "Growth phase: pool " << pooled.count() << " ms, new/delete " << baseline.count() << " ms" << endl;
+    cout << "Done!" << endl << endl;
+}
+
+void TestVectorStorage() {
+    cout << "Test vector storage" << endl;
+    SimpleVector<int> source{1, 2, 3};
+    source.Reserve(10);
+    const int* buffer = source.begin();
+    auto storage = source.DetachStorage();
+    assert(source.IsEmpty() && source.GetCapacity() == 0 && source.begin() == nullptr);
+    assert(storage.buffer.Get() == buffer && storage.size == 3 && storage.capacity == 10);
+
+    SimpleVector<int> target(5, 7);
+    target.AdoptStorage(move(storage));
+    assert(!storage.buffer && storage.size == 0);
+    assert(target.begin() == buffer && target == (SimpleVector<int>{1, 2, 3}) && target.GetCapacity() == 10);
+    SimpleVector<int> adopted(target.DetachStorage());
+    assert(adopted.begin() == buffer && adopted.GetSize() == 3 && target.IsEmpty());
+    // Распределителям, которым нужен размер массива, указатель без размера не передать
+    static_assert(is_constructible_v<ArrayPtr<int>, int*>);
+    static_assert(!is_constructible_v<PooledArrayPtr<int>, int*>);
+    static_assert(is_constructible_v<PooledArrayPtr<int>, int*, size_t>);
+
+    VectorRecycler<string> recycler(2);
+    auto first = recycler.Acquire(100);
+    assert(first.IsEmpty() && first.GetCapacity() >= 100);
+    first.PushBack("a");
+    const string* first_buffer = first.begin();
+    recycler.Release(move(first));
+    assert(recycler.GetCachedCount() == 1);
+    auto second = recycler.Acquire(50);
+    assert(second.begin() == first_buffer && second.IsEmpty() && second.GetCapacity() >= 100);
+    recycler.Release(move(second));
+    for (int i = 0; i < 5; ++i) {
+        recycler.Release(SimpleVector<string>(3));
+    }
+    assert(recycler.GetCachedCount() == 2);
+
+    // Стадии конвейера обмениваются буферами через общий пул
+    VectorRecycler<int> shared;
+    MpmcQueue<SimpleVector<int>*> pipe(4);
+    thread consumer([&] {
+        for (int i = 0; i < 1000; ++i) {
+            SimpleVector<int>* batch = pipe.Pop();
+            assert(batch->GetSize() == 64 && (*batch)[63] == i);
+            shared.Release(move(*batch));
+            delete batch;
+        }
+    });
+    for (int i = 0; i < 1000; ++i) {
+        auto batch = shared.Acquire(64);
+        for (int j = 0; j < 64; ++j) {
+            batch.PushBack(i);
+        }
+        pipe.Push(new SimpleVector<int>(move(batch)));
+    }
+    consumer.join();
+    assert(shared.GetCachedCount() >= 1);
+    cout << "Done!" << endl << endl;
+}
+
+void TestArena() {
+    cout << "Test arena" << endl;
+    Arena arena(4096);
+    {
+        ArenaScope scope(arena);
+        ArenaVector<int> numbers;
+        numbers.PushBack(0);
+        const int* buffer = numbers.begin();
+        // Последнее выделение растёт на месте
+        for (int i = 1; i < 500; ++i) {
+            numbers.PushBack(i);
+        }
+        assert(numbers.begin() == buffer && numbers.GetSize() == 500 && numbers[499] == 499);
+        assert(arena.GetReservedBytes() == 4096);
+
+        ArenaVector<string> words(3, "word");
+        words.PushBack(string(100, 'x'));
+        assert(words.GetSize() == 4 && words[3].size() == 100);
+        // Вектор перестал быть последним выделением и переезжает
+        numbers.Resize(2000);
+        assert(numbers.begin() != buffer && numbers[499] == 499 && numbers[1999] == 0);
+        assert(arena.GetReservedBytes() > 4096);
+
+        ArenaVector<int> copy(numbers);
+        assert(copy == numbers);
+        {
+            Arena nested(1024);
+            ArenaScope nested_scope(nested);
+            ArenaVector<int> inner(10, 1);
+            assert(nested.GetReservedBytes() == 1024);
+        }
+        ArenaVector<int> outer(10, 2);
+        assert(Arena::Current() == &arena);
+    }
+    assert(Arena::Current() == nullptr);
+    arena.Reset();
+    assert(arena.GetReservedBytes() >= 4096);
+    {
+        ArenaScope scope(arena);
+        ArenaVector<int> reused(100, 3);
+        assert(reused[99] == 3);
+    }
+
+    // Выровненное начало выделения за невыровненным концом блока — новый блок
+    Arena unaligned(1000);
+    unaligned.Allocate(990, 16);
+    char* tail = static_cast<char*>(unaligned.Allocate(4, 16));
+    std::fill(tail, tail + 4, 'x');
+    char* next = static_cast<char*>(unaligned.Allocate(4, 16));
+    std::fill(next, next + 4, 'y');
+    assert(reinterpret_cast<uintptr_t>(next) % 16 == 0 && unaligned.GetReservedBytes() > 1000);
+    {
+        struct alignas(64) Line {
+            char bytes[64];
+        };
+        Arena small(100);
+        ArenaScope scope(small);
+        for (int i = 0; i < 5; ++i) {
+            ArenaVector<Line> lines(2);
+            assert(reinterpret_cast<uintptr_t>(lines.begin()) % 64 == 0);
+            lines[1].bytes[63] = 'z';
+        }
+    }
+
+    // Без арены память берётся из кучи
+    ArenaVector<int> heap(5, 4);
+    heap.PushBack(5);
+    assert(heap.GetSize() == 6 && heap[5] == 5);
+    cout << "Done!" << endl << endl;
+}
+
+void TestScratchVector() {
+    cout << "Test scratch vector" << endl;
+    ScratchStack& stack = ScratchStack::Local();
+    assert(stack.GetUsedBytes() == 0);
+    {
+        ScratchVector<int> outer(10, 1);
+        const size_t outer_bytes = stack.GetUsedBytes();
+        assert(outer_bytes > 0);
+        {
+            ScratchVector<string> inner(3, "tmp");
+            inner.PushBack("more");
+            assert(stack.GetUsedBytes() > outer_bytes);
+        }
+        // Освобождение в порядке LIFO возвращает вершину стека
+        assert(stack.GetUsedBytes() == outer_bytes);
+
+        // Буфер на вершине растёт на месте
+        const int* buffer = outer.begin();
+        for (int i = 0; i < 1000; ++i) {
+            outer.PushBack(i);
+        }
+        assert(outer.begin() == buffer && outer.GetSize() == 1010 && outer[1009] == 999);
+
+        // Исчерпанный стек уступает куче
+        const size_t used = stack.GetUsedBytes();
+        ScratchVector<char> large(ScratchStack::REGION_BYTES);
+        assert(stack.GetUsedBytes() == used && large.GetSize() == ScratchStack::REGION_BYTES);
+    }
+    assert(stack.GetUsedBytes() == 0);
+
+    // Буфер, освобождённый не по порядку, возвращается вместе с последним
+    ScratchVector<int> first(100);
+    ScratchVector<int> second(100);
+    first = ScratchVector<int>();
+    assert(stack.GetUsedBytes() > 0);
+    second = ScratchVector<int>();
+    assert(stack.GetUsedBytes() == 0);
+
+    thread other([] {
+        ScratchVector<double> local(50, 1.5);
+        assert(ScratchStack::Local().GetUsedBytes() > 0 && local[49] == 1.5);
+    });
+    other.join();
+    assert(stack.GetUsedBytes() == 0);
+    cout << "Done!" << endl << endl;
+}
+
 int main() {
     TestTemporaryObjConstructor();
     TestTemporaryObjOperator();
@@ -160,5 +1541,33 @@ int main() {
     TestNoncopiablePushBack();
     TestNoncopiableInsert();
     TestNoncopiableErase();
+    TestParallelFor();
+    TestParallelReduce();
+    TestInclusiveScan();
+    TestExclusiveScan();
+    TestConcurrentPushBack();
+    TestParallelWrite();
+    TestSnapshotVector();
+    TestSeqlockVector();
+    TestSpscRing();
+    TestMpmcQueue();
+    TestCircularVector();
+    TestCircularVectorWindow();
+    TestGapVector();
+    TestSegmentedVector();
+    TestCowVector();
+    TestImmutableVector();
+    TestMappedVector();
+    TestSerialization();
+    TestVectorStream();
+    TestHugePageAllocator();
+    TestHugePageGrowth();
+    TestAlignedSimpleVector();
+    TestPrefault();
+    TestDeferredFree();
+    TestPoolAllocator();
+    TestVectorStorage();
+    TestArena();
+    TestScratchVector();
     return 0;
 }
@@ -0,0 +1,263 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Режим открытия файла для MappedVector
+enum class MapMode {
+    // Только чтение: файл должен существовать
+    READ_ONLY,
+    // Чтение и запись: файл создаётся, если его нет
+    READ_WRITE,
+};
+
+// Вектор, хранящий элементы в отображённом в память файле (mmap).
+// Открытие не читает файл: страницы подгружаются операционной системой при первом обращении.
+// Формат файла — элементы подряд без заголовка, поэтому Type должен быть тривиально копируемым.
+// При росте файл удлиняется через ftruncate, а отображение расширяется через mremap без
+// копирования. Пока файл открыт на запись, его длина равна вместимости; при закрытии
+// файл обрезается до размера вектора
+template <typename Type>
+class MappedVector {
+    static_assert(std::is_trivially_copyable_v<Type>, "MappedVector requires trivially copyable type");
+
+public:
+    using Iterator = Type*;
+    using ConstIterator = const Type*;
+
+    // Открывает файл path и отображает его в память. Размер вектора — длина файла в элементах.
+    // Ошибки системных вызовов сообщаются исключением std::system_error
+    explicit MappedVector(const std::string& path, MapMode mode = MapMode::READ_ONLY) : mode_(mode) {
+        const int flags = mode_ == MapMode::READ_ONLY ? O_RDONLY : O_RDWR | O_CREAT;
+        fd_ = ::open(path.c_str(), flags, 0644);
+        if (fd_ < 0) {
+            ThrowSystemError("open " + path);
+        }
+        struct stat info {};
+        if (::fstat(fd_, &info) != 0) {
+            const int error = errno;
+            ::close(fd_);
+            errno = error;
+            ThrowSystemError("fstat " + path);
+        }
+        size_ = static_cast<size_t>(info.st_size) / sizeof(Type);
+        try {
+            Map(size_);
+        } catch (...) {
+            ::close(fd_);
+            throw;
+        }
+    }
+
+    MappedVector(const MappedVector&) = delete;
+    MappedVector& operator=(const MappedVector&) = delete;
+
+    MappedVector(MappedVector&& other) noexcept {
+        swap(other);
+    }
+
+    MappedVector& operator=(MappedVector&& rhs) noexcept {
+        MappedVector tmp(std::move(rhs));
+        swap(tmp);
+        return *this;
+    }
+
+    // Снимает отображение и обрезает файл до размера вектора
+    ~MappedVector() {
+        if (fd_ < 0) {
+            return;
+        }
+        if (data_ != nullptr) {
+            ::munmap(data_, capacity_ * sizeof(Type));
+        }
+        if (mode_ == MapMode::READ_WRITE && capacity_ != size_) {
+            [[maybe_unused]] const int result = ::ftruncate(fd_, static_cast<off_t>(size_ * sizeof(Type)));
+        }
+        ::close(fd_);
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(MappedVector& other) noexcept {
+        std::swap(fd_, other.fd_);
+        std::swap(mode_, other.mode_);
+        std::swap(data_, other.data_);
+        std::swap(size_, other.size_);
+        std::swap(capacity_, other.capacity_);
+    }
+
+    // Возвращает количество элементов
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает длину отображения в элементах
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Сообщает, пуст ли вектор
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return data_[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return data_[index];
+    }
+
+    // Увеличивает файл и отображение до new_capacity элементов.
+    // Изменяющие методы выбрасывают std::logic_error для вектора, открытого только на чтение
+    void Reserve(size_t new_capacity) {
+        if (new_capacity > capacity_) {
+            Grow(new_capacity);
+        }
+    }
+
+    // Изменяет размер. Новые элементы заполняются нулями (так файл удлиняет ftruncate)
+    void Resize(size_t new_size) {
+        if (new_size > capacity_) {
+            Grow(std::max(new_size, capacity_ * 2));
+        }
+        if (new_size > size_) {
+            std::fill(data_ + size_, data_ + new_size, Type());
+        }
+        size_ = new_size;
+    }
+
+    // Добавляет элемент в конец, удваивая длину файла при нехватке места.
+    // Рост может переместить отображение: указатели и итераторы инвалидируются
+    void PushBack(const Type& item) {
+        if (size_ == capacity_) {
+            Grow(std::max<size_t>(capacity_ * 2, 1));
+        }
+        data_[size_++] = item;
+    }
+
+    // "Удаляет" последний элемент. Для пустого вектора ничего не делает
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+        }
+    }
+
+    // Обнуляет размер, не изменяя длину отображения
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    // Синхронно записывает изменённые страницы на диск (msync)
+    void Flush() {
+        if (data_ != nullptr && ::msync(data_, capacity_ * sizeof(Type), MS_SYNC) != 0) {
+            ThrowSystemError("msync");
+        }
+    }
+
+    Iterator begin() noexcept {
+        return data_;
+    }
+
+    Iterator end() noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator end() const noexcept {
+        return data_ + size_;
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return data_;
+    }
+
+    ConstIterator cend() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    [[noreturn]] static void ThrowSystemError(const std::string& what) {
+        throw std::system_error(errno, std::generic_category(), what);
+    }
+
+    int Protection() const noexcept {
+        return mode_ == MapMode::READ_ONLY ? PROT_READ : PROT_READ | PROT_WRITE;
+    }
+
+    void Map(size_t capacity) {
+        if (capacity == 0) {
+            return;
+        }
+        void* address = ::mmap(nullptr, capacity * sizeof(Type), Protection(), MAP_SHARED, fd_, 0);
+        if (address == MAP_FAILED) {
+            ThrowSystemError("mmap");
+        }
+        data_ = static_cast<Type*>(address);
+        capacity_ = capacity;
+    }
+
+    void Grow(size_t new_capacity) {
+        if (mode_ == MapMode::READ_ONLY) {
+            throw std::logic_error("MappedVector is read-only");
+        }
+        if (::ftruncate(fd_, static_cast<off_t>(new_capacity * sizeof(Type))) != 0) {
+            ThrowSystemError("ftruncate");
+        }
+        if (data_ == nullptr) {
+            Map(new_capacity);
+            return;
+        }
+#if defined(__linux__)
+        void* address = ::mremap(data_, capacity_ * sizeof(Type), new_capacity * sizeof(Type), MREMAP_MAYMOVE);
+        if (address == MAP_FAILED) {
+            ThrowSystemError("mremap");
+        }
+        data_ = static_cast<Type*>(address);
+        capacity_ = new_capacity;
+#else
+        ::munmap(data_, capacity_ * sizeof(Type));
+        data_ = nullptr;
+        capacity_ = 0;
+        Map(new_capacity);
+#endif
+    }
+
+    int fd_ = -1;
+    MapMode mode_ = MapMode::READ_ONLY;
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+    size_t capacity_ = 0;
+};
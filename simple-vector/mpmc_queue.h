@@ -0,0 +1,141 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <thread>
+#include <utility>
+
+#include "array_ptr.h"
+#include "bit_utils.h"
+
+// Ограниченная очередь для многих производителей и потребителей (алгоритм Д. Вьюкова).
+// Каждая ячейка хранит номер последовательности: он показывает, свободна ли ячейка
+// для записи на текущем круге или уже содержит значение для чтения.
+// Ячейки и индексы выровнены по кэш-линии, чтобы потоки не мешали друг другу
+template <typename Type>
+class MpmcQueue {
+    static constexpr size_t CACHE_LINE = 64;
+
+    struct alignas(CACHE_LINE) Slot {
+        std::atomic<size_t> sequence{0};
+        Type value{};
+    };
+
+public:
+    // Вместимость округляется вверх до степени двойки, но не меньше 2: при одной ячейке
+    // номер последовательности заполненной ячейки совпадает с номером следующей записи
+    explicit MpmcQueue(size_t capacity)
+        : mask_(RoundUpToPowerOfTwo(std::max<size_t>(capacity, 2)) - 1), slots_(mask_ + 1) {
+        for (size_t i = 0; i <= mask_; ++i) {
+            slots_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    MpmcQueue(const MpmcQueue&) = delete;
+    MpmcQueue& operator=(const MpmcQueue&) = delete;
+
+    size_t GetCapacity() const noexcept {
+        return mask_ + 1;
+    }
+
+    // Возвращает false, если очередь заполнена
+    bool TryPush(const Type& item) {
+        return Emplace(item);
+    }
+
+    bool TryPush(Type&& item) {
+        return Emplace(std::move(item));
+    }
+
+    // Возвращает false, если очередь пуста
+    bool TryPop(Type& item) {
+        size_t position = head_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - (position + 1));
+            if (diff == 0) {
+                if (head_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    item = std::move(slot.value);
+                    slot.sequence.store(position + mask_ + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = head_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Блокирующие варианты: ждут, пока в очереди появится место или элемент
+    void Push(const Type& item) {
+        for (size_t attempt = 0; !TryPush(item); ++attempt) {
+            Backoff(attempt);
+        }
+    }
+
+    void Push(Type&& item) {
+        for (size_t attempt = 0; !TryPush(std::move(item)); ++attempt) {
+            Backoff(attempt);
+        }
+    }
+
+    Type Pop() {
+        Type item;
+        for (size_t attempt = 0; !TryPop(item); ++attempt) {
+            Backoff(attempt);
+        }
+        return item;
+    }
+
+private:
+    // Неудачная попытка TryPush не трогает аргумент, поэтому повторная передача
+    // того же rvalue в Push безопасна
+    template <typename Value>
+    bool Emplace(Value&& item) {
+        size_t position = tail_.load(std::memory_order_relaxed);
+        while (true) {
+            Slot& slot = slots_[position & mask_];
+            const size_t sequence = slot.sequence.load(std::memory_order_acquire);
+            const auto diff = static_cast<std::ptrdiff_t>(sequence - position);
+            if (diff == 0) {
+                if (tail_.compare_exchange_weak(position, position + 1, std::memory_order_relaxed)) {
+                    slot.value = std::forward<Value>(item);
+                    slot.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            } else if (diff < 0) {
+                return false;
+            } else {
+                position = tail_.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    // Первые попытки ждут инструкцией pause, с каждой попыткой дольше, чтобы не нагружать
+    // кэш-линию ячейки; затем поток уступает процессор
+    static void Backoff(size_t attempt) {
+        if (attempt >= 16) {
+            std::this_thread::yield();
+            return;
+        }
+        for (size_t i = size_t(1) << (attempt / 2); i != 0; --i) {
+            CpuRelax();
+        }
+    }
+
+    static void CpuRelax() noexcept {
+#if defined(__x86_64__) || defined(__i386__)
+        __builtin_ia32_pause();
+#elif defined(__aarch64__)
+        asm volatile("yield");
+#endif
+    }
+
+    const size_t mask_;
+    ArrayPtr<Slot> slots_;
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+};
@@ -0,0 +1,158 @@
+#pragma once
+
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+#include "simple_vector.h"
+#include "thread_pool.h"
+
+namespace scan_detail {
+
+// Размер блока, обрабатываемого одной задачей. Меньшие векторы сканируются последовательно
+constexpr size_t BLOCK_SIZE = size_t{1} << 16;
+
+template <typename Type>
+struct NonDeduced {
+    using type = Type;
+};
+
+template <typename Type, typename BinaryOp>
+using EnableIfOp = std::enable_if_t<std::is_invocable_v<BinaryOp&, const Type&, const Type&>, int>;
+
+// Свёртка блока [first, last), first != last
+template <typename Type, typename BinaryOp>
+Type ReduceBlock(const Type* first, const Type* last, BinaryOp& op) {
+    Type sum = *first;
+    for (++first; first != last; ++first) {
+        sum = op(sum, *first);
+    }
+    return sum;
+}
+
+// Включающее сканирование блока, продолжающее накопленное значение carry
+template <typename Type, typename BinaryOp>
+void InclusiveScanBlock(const Type* first, const Type* last, Type* out, Type carry, BinaryOp& op) {
+    for (; first != last; ++first, ++out) {
+        carry = op(carry, *first);
+        *out = carry;
+    }
+}
+
+#if defined(__SSE2__)
+// Для int и сложения сканируем по четыре элемента: сдвиги регистра на 1 и 2 элемента
+// дают префиксные суммы внутри регистра, к ним прибавляется перенос из предыдущей четвёрки
+inline void InclusiveScanBlock(const int* first, const int* last, int* out, int carry, std::plus<>&) {
+    __m128i vcarry = _mm_set1_epi32(carry);
+    for (; last - first >= 4; first += 4, out += 4) {
+        __m128i x = _mm_loadu_si128(reinterpret_cast<const __m128i*>(first));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 4));
+        x = _mm_add_epi32(x, _mm_slli_si128(x, 8));
+        x = _mm_add_epi32(x, vcarry);
+        _mm_storeu_si128(reinterpret_cast<__m128i*>(out), x);
+        vcarry = _mm_shuffle_epi32(x, 0xFF);
+    }
+    carry = _mm_cvtsi128_si32(vcarry);
+    for (; first != last; ++first, ++out) {
+        carry += *first;
+        *out = carry;
+    }
+}
+#endif
+
+// Исключающее сканирование блока: в out[i] записывается свёртка carry и элементов до i.
+// Допускается out == first
+template <typename Type, typename BinaryOp>
+void ExclusiveScanBlock(const Type* first, const Type* last, Type* out, Type carry, BinaryOp& op) {
+    for (; first != last; ++first, ++out) {
+        Type value = *first;
+        *out = carry;
+        carry = op(carry, value);
+    }
+}
+
+// Двухпроходный блочный алгоритм: сначала параллельно считаются суммы блоков,
+// затем их префиксы последовательно, затем каждый блок сканируется со своим переносом
+template <typename Type, typename BinaryOp>
+void Scan(const Type* in, Type* out, size_t size, const Type* init, BinaryOp& op) {
+    if (size == 0) {
+        return;
+    }
+    const size_t block_count = parallel_detail::BlockCount(size, BLOCK_SIZE);
+    auto block_first = [](size_t block) { return block * BLOCK_SIZE; };
+    auto block_last = [size](size_t block) { return std::min((block + 1) * BLOCK_SIZE, size); };
+
+    SimpleVector<Type> carries(block_count);
+    if (block_count > 1) {
+        SimpleVector<Type> sums(block_count);
+        ParallelFor(block_count - 1, 1, [&](size_t first, size_t last) {
+            for (size_t block = first; block < last; ++block) {
+                sums[block] = ReduceBlock(in + block_first(block), in + block_last(block), op);
+            }
+        });
+        Type carry = init != nullptr ? op(*init, sums[0]) : sums[0];
+        for (size_t block = 1; block < block_count; ++block) {
+            carries[block] = carry;
+            carry = op(carry, sums[block]);
+        }
+    }
+
+    auto scan_block = [&](size_t block) {
+        const Type* first = in + block_first(block);
+        const Type* last = in + block_last(block);
+        Type* dest = out + block_first(block);
+        if (init != nullptr) {
+            ExclusiveScanBlock(first, last, dest, block == 0 ? *init : carries[block], op);
+        } else if (block == 0) {
+            *dest = *first;
+            InclusiveScanBlock(first + 1, last, dest + 1, *dest, op);
+        } else {
+            InclusiveScanBlock(first, last, dest, carries[block], op);
+        }
+    };
+    if (block_count == 1) {
+        scan_block(0);
+        return;
+    }
+    ParallelFor(block_count, 1, [&](size_t first, size_t last) {
+        for (size_t block = first; block < last; ++block) {
+            scan_block(block);
+        }
+    });
+}
+
+} // namespace scan_detail
+
+// Заменяет каждый элемент свёрткой op всех элементов до него включительно.
+// op должна быть ассоциативной: порядок вычислений зависит от разбиения на блоки
+template <typename Type, typename Allocator, typename BinaryOp = std::plus<>,
+          scan_detail::EnableIfOp<Type, BinaryOp> = 0>
+void InclusiveScan(SimpleVector<Type, Allocator>& vec, BinaryOp op = {}) {
+    scan_detail::Scan<Type>(vec.begin(), vec.begin(), vec.GetSize(), nullptr, op);
+}
+
+// Записывает в out включающие префиксные свёртки in. Размер out становится равным размеру in
+template <typename Type, typename InAllocator, typename OutAllocator, typename BinaryOp = std::plus<>>
+void InclusiveScan(const SimpleVector<Type, InAllocator>& in, SimpleVector<Type, OutAllocator>& out, BinaryOp op = {}) {
+    out.Resize(in.GetSize());
+    scan_detail::Scan<Type>(in.begin(), out.begin(), in.GetSize(), nullptr, op);
+}
+
+// Заменяет каждый элемент свёрткой init и всех элементов перед ним
+template <typename Type, typename Allocator, typename BinaryOp = std::plus<>>
+void ExclusiveScan(SimpleVector<Type, Allocator>& vec, const typename scan_detail::NonDeduced<Type>::type& init,
+                   BinaryOp op = {}) {
+    scan_detail::Scan<Type>(vec.begin(), vec.begin(), vec.GetSize(), &init, op);
+}
+
+// Записывает в out исключающие префиксные свёртки in, начиная с init
+template <typename Type, typename InAllocator, typename OutAllocator, typename BinaryOp = std::plus<>>
+void ExclusiveScan(const SimpleVector<Type, InAllocator>& in, SimpleVector<Type, OutAllocator>& out,
+                   const typename scan_detail::NonDeduced<Type>::type& init, BinaryOp op = {}) {
+    out.Resize(in.GetSize());
+    scan_detail::Scan<Type>(in.begin(), out.begin(), in.GetSize(), &init, op);
+}
@@ -0,0 +1,288 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <new>
+
+#include "array_ptr.h"
+#include "bit_utils.h"
+#include "simple_vector.h"
+
+// Пул буферов по классам размеров — степеням двойки от 16 байт до 1 МБ.
+// Освобождённый буфер кладётся в список своего класса в кэше текущего потока,
+// и следующее выделение того же класса — это снятие указателя со списка без блокировок.
+// Когда в кэше потока больше thread_limit буферов класса, половина уходит в общее
+// хранилище (depot), откуда её забирают потоки с пустым кэшем. Сверх depot_limit
+// буферы возвращаются в кучу. Буферы больше 1 МБ не кэшируются
+class BufferPool {
+public:
+    static constexpr size_t MIN_CLASS_BITS = 4;
+    static constexpr size_t MAX_CLASS_BITS = 20;
+    static constexpr size_t CLASS_COUNT = MAX_CLASS_BITS - MIN_CLASS_BITS + 1;
+    static constexpr size_t MAX_BYTES = size_t(1) << MAX_CLASS_BITS;
+    static constexpr size_t DEFAULT_THREAD_LIMIT = 32;
+    static constexpr size_t DEFAULT_DEPOT_LIMIT = 256;
+
+    // Выдаёт буфер не меньше bytes байт с выравниванием operator new по умолчанию
+    static void* Allocate(size_t bytes) {
+        if (bytes > MAX_BYTES) {
+            return ::operator new(bytes);
+        }
+        const size_t size_class = ClassOf(bytes);
+        if (!cache_destroyed_) {
+            FreeList& list = Cache().lists[size_class];
+            if (list.IsEmpty()) {
+                GetDepot().Take(size_class, list, BatchSize());
+            }
+            if (!list.IsEmpty()) {
+                return list.Pop();
+            }
+        }
+        return ::operator new(ClassBytes(size_class));
+    }
+
+    // Возвращает в пул буфер, выданный Allocate с тем же bytes
+    static void Deallocate(void* buffer, size_t bytes) noexcept {
+        if (bytes > MAX_BYTES) {
+            ::operator delete(buffer);
+            return;
+        }
+        const size_t size_class = ClassOf(bytes);
+        if (cache_destroyed_) {
+            FreeList single;
+            single.Push(buffer);
+            GetDepot().Put(size_class, single, 1);
+            return;
+        }
+        FreeList& list = Cache().lists[size_class];
+        list.Push(buffer);
+        if (list.count > thread_limit_.load(std::memory_order_relaxed)) {
+            GetDepot().Put(size_class, list, std::max<size_t>(list.count / 2, 1));
+        }
+    }
+
+    // Задаёт, сколько буферов каждого класса хранить в кэше потока и в общем хранилище
+    static void SetLimits(size_t thread_limit, size_t depot_limit) noexcept {
+        thread_limit_.store(thread_limit, std::memory_order_relaxed);
+        depot_limit_.store(depot_limit, std::memory_order_relaxed);
+    }
+
+    // Задаёт лимиты на время своего существования и восстанавливает прежние при разрушении
+    class ScopedLimits {
+    public:
+        ScopedLimits(size_t thread_limit, size_t depot_limit) noexcept
+            : previous_thread_limit_(thread_limit_.exchange(thread_limit, std::memory_order_relaxed))
+            , previous_depot_limit_(depot_limit_.exchange(depot_limit, std::memory_order_relaxed)) {
+        }
+
+        ScopedLimits(const ScopedLimits&) = delete;
+        ScopedLimits& operator=(const ScopedLimits&) = delete;
+
+        ~ScopedLimits() {
+            SetLimits(previous_thread_limit_, previous_depot_limit_);
+        }
+
+    private:
+        size_t previous_thread_limit_;
+        size_t previous_depot_limit_;
+    };
+
+    // Количество буферов класса, к которому относится bytes, в кэше текущего потока
+    static size_t GetCachedCount(size_t bytes) {
+        return bytes > MAX_BYTES || cache_destroyed_ ? 0 : Cache().lists[ClassOf(bytes)].count;
+    }
+
+    // Количество буферов класса, к которому относится bytes, в общем хранилище
+    static size_t GetDepotCount(size_t bytes) {
+        if (bytes > MAX_BYTES) {
+            return 0;
+        }
+        Depot& depot = GetDepot();
+        std::lock_guard<std::mutex> lock(depot.mutex);
+        return depot.lists[ClassOf(bytes)].count;
+    }
+
+    // Размер буферов класса size_class
+    static size_t ClassBytes(size_t size_class) noexcept {
+        return size_t(1) << (size_class + MIN_CLASS_BITS);
+    }
+
+    // Класс размера, буферы которого вмещают bytes байт
+    static size_t ClassOf(size_t bytes) noexcept {
+        const size_t rounded = RoundUpToPowerOfTwo(std::max<size_t>(bytes, size_t(1) << MIN_CLASS_BITS));
+        return HighestBitIndex(rounded) - MIN_CLASS_BITS;
+    }
+
+private:
+    // Односвязный список, звенья которого хранятся в самих свободных буферах
+    struct FreeList {
+        struct Node {
+            Node* next;
+        };
+
+        bool IsEmpty() const noexcept {
+            return head == nullptr;
+        }
+
+        void Push(void* buffer) noexcept {
+            head = new (buffer) Node{head};
+            ++count;
+        }
+
+        void* Pop() noexcept {
+            Node* node = head;
+            head = node->next;
+            --count;
+            return node;
+        }
+
+        Node* head = nullptr;
+        size_t count = 0;
+    };
+
+    struct Depot {
+        // Переносит до count буферов в список потока. Пустой класс проверяется без блокировки,
+        // чтобы потоки с пустыми кэшами не выстраивались в очередь за мьютексом
+        void Take(size_t size_class, FreeList& to, size_t count) {
+            if (available[size_class].load(std::memory_order_relaxed) == 0) {
+                return;
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            FreeList& from = lists[size_class];
+            for (; count != 0 && !from.IsEmpty(); --count) {
+                to.Push(from.Pop());
+            }
+            available[size_class].store(from.count, std::memory_order_relaxed);
+        }
+
+        // Забирает count буферов из списка потока. Не поместившиеся в хранилище освобождаются
+        void Put(size_t size_class, FreeList& from, size_t count) noexcept {
+            FreeList excess;
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                FreeList& to = lists[size_class];
+                const size_t limit = closed ? 0 : depot_limit_.load(std::memory_order_relaxed);
+                for (; count != 0 && !from.IsEmpty(); --count) {
+                    if (to.count < limit) {
+                        to.Push(from.Pop());
+                    } else {
+                        excess.Push(from.Pop());
+                    }
+                }
+                available[size_class].store(to.count, std::memory_order_relaxed);
+            }
+            Free(excess);
+        }
+
+        // Освобождает все буферы хранилища. Буферы, возвращённые позже, сразу уходят в кучу
+        void Close() noexcept {
+            FreeList released[CLASS_COUNT];
+            {
+                std::lock_guard<std::mutex> lock(mutex);
+                closed = true;
+                std::swap(lists, released);
+                for (std::atomic<size_t>& count : available) {
+                    count.store(0, std::memory_order_relaxed);
+                }
+            }
+            for (FreeList& list : released) {
+                Free(list);
+            }
+        }
+
+        static void Free(FreeList& list) noexcept {
+            while (!list.IsEmpty()) {
+                ::operator delete(list.Pop());
+            }
+        }
+
+        std::mutex mutex;
+        FreeList lists[CLASS_COUNT];
+        // Копии lists[i].count для проверки без блокировки. Устаревшее значение лишь
+        // пропускает буферы, положенные только что, или приводит к лишней блокировке
+        std::atomic<size_t> available[CLASS_COUNT] = {};
+        bool closed = false;
+    };
+
+    // Статический объект, который при завершении программы освобождает буферы хранилища
+    struct DepotCloser {
+        ~DepotCloser() {
+            GetDepot().Close();
+        }
+    };
+
+    // При завершении потока отдаёт его буферы в общее хранилище
+    struct ThreadCache {
+        ~ThreadCache() {
+            cache_destroyed_ = true;
+            for (size_t size_class = 0; size_class < CLASS_COUNT; ++size_class) {
+                GetDepot().Put(size_class, lists[size_class], lists[size_class].count);
+            }
+        }
+
+        FreeList lists[CLASS_COUNT];
+    };
+
+    static size_t BatchSize() noexcept {
+        return std::max<size_t>(thread_limit_.load(std::memory_order_relaxed) / 2, 1);
+    }
+
+    static ThreadCache& Cache() {
+        static thread_local ThreadCache cache;
+        return cache;
+    }
+
+    // Сам объект хранилища не разрушается: векторы со статическим временем жизни
+    // освобождают буферы и после DepotCloser, такие буферы возвращаются прямо в кучу
+    static Depot& GetDepot() {
+        static Depot* const depot = new Depot();
+        static DepotCloser closer;
+        return *depot;
+    }
+
+    // Кэш потока уже разрушен (поток завершается): буферы идут прямо в хранилище
+    inline static thread_local bool cache_destroyed_ = false;
+    inline static std::atomic<size_t> thread_limit_{DEFAULT_THREAD_LIMIT};
+    inline static std::atomic<size_t> depot_limit_{DEFAULT_DEPOT_LIMIT};
+};
+
+// Распределитель ArrayPtr на буферах BufferPool. Типы с выравниванием больше,
+// чем даёт operator new по умолчанию, выделяются в обычной куче
+struct PoolAllocator {
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        if constexpr (alignof(Type) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            return NewDeleteAllocator::Allocate<Type>(size);
+        } else {
+            if (size > SIZE_MAX / sizeof(Type)) {
+                throw std::bad_array_new_length();
+            }
+            void* memory = BufferPool::Allocate(size * sizeof(Type));
+            try {
+                return array_detail::ConstructElements<Type>(memory, size, false);
+            } catch (...) {
+                BufferPool::Deallocate(memory, size * sizeof(Type));
+                throw;
+            }
+        }
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        if constexpr (alignof(Type) > __STDCPP_DEFAULT_NEW_ALIGNMENT__) {
+            NewDeleteAllocator::Deallocate(data, size);
+        } else {
+            array_detail::DestroyElements(data, size);
+            BufferPool::Deallocate(data, size * sizeof(Type));
+        }
+    }
+};
+
+template <typename Type>
+using PooledArrayPtr = ArrayPtr<Type, PoolAllocator>;
+
+template <typename Type>
+using PooledSimpleVector = SimpleVector<Type, PoolAllocator>;
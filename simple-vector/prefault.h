@@ -0,0 +1,152 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <thread>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+// Когда делать резидентными страницы зарезервированного буфера
+enum class PrefaultPolicy {
+    // Страницы подгружаются при первом обращении
+    NONE,
+    // Все страницы подгружаются до возврата из Reserve
+    POPULATE,
+    // Страницы подгружает фоновый поток, Reserve возвращается сразу.
+    // Нужна поддержка MADV_POPULATE_WRITE (Linux 5.14), иначе ничего не делает
+    BACKGROUND,
+};
+
+namespace prefault_detail {
+
+inline size_t PageSize() noexcept {
+    static const size_t page_size = static_cast<size_t>(::sysconf(_SC_PAGESIZE));
+    return page_size;
+}
+
+// Заранее создаёт записываемые страницы ядром, не изменяя данных. Возвращает false,
+// если ядро не поддерживает MADV_POPULATE_WRITE (Linux до 5.14)
+inline bool PopulateWrite(void* data, size_t bytes) noexcept {
+#if defined(MADV_POPULATE_WRITE)
+    const uintptr_t first = reinterpret_cast<uintptr_t>(data) / PageSize() * PageSize();
+    const uintptr_t last = reinterpret_cast<uintptr_t>(data) + bytes;
+    return ::madvise(reinterpret_cast<void*>(first), last - first, MADV_POPULATE_WRITE) == 0;
+#else
+    return false;
+#endif
+}
+
+// Поддерживает ли ядро MADV_POPULATE_WRITE. Для пустого диапазона madvise
+// проверяет только совет, поэтому вызов ничего не меняет
+inline bool PopulateWriteSupported() noexcept {
+#if defined(MADV_POPULATE_WRITE)
+    static const bool supported = ::madvise(nullptr, 0, MADV_POPULATE_WRITE) == 0;
+    return supported;
+#else
+    return false;
+#endif
+}
+
+// Записывает в каждую страницу её же байт. Годится только пока буфером не пользуются другие потоки
+inline void TouchPages(void* data, size_t bytes) noexcept {
+    volatile char* first = static_cast<char*>(data);
+    for (size_t offset = 0; offset < bytes; offset += PageSize()) {
+        first[offset] = first[offset];
+    }
+    first[bytes - 1] = first[bytes - 1];
+}
+
+}  // namespace prefault_detail
+
+// Фоновая подгрузка страниц буфера. Поток подгружает буфер порциями по CHUNK_BYTES
+// и между порциями проверяет флаг отмены. Владелец буфера отменяет подгрузку
+// (Cancel или деструктор) до того, как освободит или переместит буфер
+class PrefaultJob {
+public:
+    static constexpr size_t CHUNK_BYTES = size_t(2) << 20;
+
+    PrefaultJob() noexcept = default;
+
+    // Запускает подгрузку [data, data + bytes). Если поток не удалось создать, ничего не делает
+    PrefaultJob(void* data, size_t bytes) noexcept {
+        if (!prefault_detail::PopulateWriteSupported()) {
+            return;
+        }
+        try {
+            state_ = std::make_unique<State>();
+            state_->thread = std::thread([state = state_.get(), first = static_cast<char*>(data), bytes] {
+                for (size_t offset = 0; offset < bytes && !state->cancelled.load(std::memory_order_relaxed);
+                     offset += CHUNK_BYTES) {
+                    prefault_detail::PopulateWrite(first + offset, std::min(CHUNK_BYTES, bytes - offset));
+                }
+            });
+        } catch (...) {
+            state_.reset();
+        }
+    }
+
+    PrefaultJob(PrefaultJob&& other) noexcept = default;
+
+    PrefaultJob& operator=(PrefaultJob&& other) noexcept {
+        Cancel();
+        state_ = std::move(other.state_);
+        return *this;
+    }
+
+    ~PrefaultJob() {
+        Cancel();
+    }
+
+    // Прерывает подгрузку и ждёт завершения потока
+    void Cancel() noexcept {
+        if (state_) {
+            state_->cancelled.store(true, std::memory_order_relaxed);
+            Wait();
+        }
+    }
+
+    // Ждёт, пока поток подгрузит весь буфер (или остановится после Cancel)
+    void Wait() noexcept {
+        if (state_) {
+            state_->thread.join();
+            state_.reset();
+        }
+    }
+
+    void swap(PrefaultJob& other) noexcept {
+        state_.swap(other.state_);
+    }
+
+private:
+    struct State {
+        std::atomic<bool> cancelled{false};
+        std::thread thread;
+    };
+
+    std::unique_ptr<State> state_;
+};
+
+// Делает резидентными страницы диапазона [data, data + bytes) согласно policy.
+// Для BACKGROUND возвращает задание подгрузки, которое нужно отменить до освобождения буфера.
+// Фоновая подгрузка выполняется только ядром (MADV_POPULATE_WRITE), поэтому не мешает
+// записи в буфер
+inline PrefaultJob Prefault(void* data, size_t bytes, PrefaultPolicy policy) {
+    if (data == nullptr || bytes == 0) {
+        return PrefaultJob();
+    }
+    switch (policy) {
+        case PrefaultPolicy::NONE:
+            break;
+        case PrefaultPolicy::POPULATE:
+            if (!prefault_detail::PopulateWrite(data, bytes)) {
+                prefault_detail::TouchPages(data, bytes);
+            }
+            break;
+        case PrefaultPolicy::BACKGROUND:
+            return PrefaultJob(data, bytes);
+    }
+    return PrefaultJob();
+}
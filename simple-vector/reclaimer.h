@@ -0,0 +1,171 @@
+#pragma once
+
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+
+#include "array_ptr.h"
+#include "mpmc_queue.h"
+
+// Фоновый поток, освобождающий переданные ему буферы, чтобы munmap и free больших
+// буферов не задерживали поток, разрушающий вектор.
+// Очередь ограничена: если она заполнена, буфер освобождается в вызывающем потоке,
+// поэтому память, ожидающая освобождения, не растёт без предела
+class Reclaimer {
+public:
+    using ReleaseFunc = void (*)(void* data, size_t size);
+
+    static constexpr size_t DEFAULT_QUEUE_CAPACITY = 64;
+
+    explicit Reclaimer(size_t queue_capacity = DEFAULT_QUEUE_CAPACITY)
+        : queue_(queue_capacity), thread_([this] {
+              Loop();
+          }) {}
+
+    Reclaimer(const Reclaimer&) = delete;
+    Reclaimer& operator=(const Reclaimer&) = delete;
+
+    // Освобождает всё, что осталось в очереди, и останавливает поток
+    ~Reclaimer() {
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            stop_ = true;
+        }
+        wake_cv_.notify_one();
+        thread_.join();
+    }
+
+    // Общий для DeferredFreeAllocator поток. Объект намеренно не разрушается:
+    // буферы статических векторов могут приходить и во время завершения программы
+    static Reclaimer& Instance() {
+        static Reclaimer* reclaimer = new Reclaimer();
+        return *reclaimer;
+    }
+
+    // То же, что Instance, но вместо исключения возвращает nullptr,
+    // если поток не удалось создать
+    static Reclaimer* TryInstance() noexcept {
+        try {
+            return &Instance();
+        } catch (...) {
+            return nullptr;
+        }
+    }
+
+    // Передаёт буфер фоновому потоку: тот вызовет release(data, size)
+    void Submit(ReleaseFunc release, void* data, size_t size) noexcept {
+        pending_.fetch_add(1);
+        if (!queue_.TryPush(Job{release, data, size})) {
+            release(data, size);
+            FinishJob();
+            return;
+        }
+        queued_.fetch_add(1);
+        if (sleeping_.load() != 0) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            wake_cv_.notify_one();
+        }
+    }
+
+    // Ждёт, пока будут освобождены все переданные буферы
+    void Drain() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        drained_cv_.wait(lock, [this]() { return pending_.load() == 0; });
+    }
+
+    // Количество буферов, ожидающих освобождения
+    size_t GetPending() const noexcept {
+        return pending_.load();
+    }
+
+private:
+    struct Job {
+        ReleaseFunc release = nullptr;
+        void* data = nullptr;
+        size_t size = 0;
+    };
+
+    // Уменьшает счётчик ожидающих буферов и будит Drain, когда он обнулился
+    void FinishJob() noexcept {
+        if (pending_.fetch_sub(1) == 1) {
+            { std::lock_guard<std::mutex> lock(mutex_); }
+            drained_cv_.notify_all();
+        }
+    }
+
+    void Loop() {
+        while (true) {
+            Job job;
+            if (queue_.TryPop(job)) {
+                queued_.fetch_sub(1);
+                job.release(job.data, job.size);
+                FinishJob();
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(mutex_);
+            if (stop_ && pending_.load() == 0) {
+                break;
+            }
+            sleeping_.fetch_add(1);
+            wake_cv_.wait(lock, [this]() { return stop_ || queued_.load() > 0; });
+            sleeping_.fetch_sub(1);
+        }
+    }
+
+    MpmcQueue<Job> queue_;
+    std::atomic<size_t> pending_{0};
+    // Буферы в очереди. Увеличивается после успешного TryPush, поэтому буфер, освобождаемый
+    // в Submit, не будит поток. Может ненадолго стать отрицательным, если поток забрал
+    // буфер раньше, чем Submit увеличил счётчик
+    std::atomic<std::ptrdiff_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex mutex_;
+    std::condition_variable wake_cv_;
+    std::condition_variable drained_cv_;
+    bool stop_ = false;
+    std::thread thread_;
+};
+
+// Распределитель, отдающий освобождение больших буферов (от MinBytes) потоку Reclaimer.
+// Память выделяет и освобождает Base. В фон уходят только тривиально разрушаемые
+// элементы, чтобы деструкторы не выполнялись в чужом потоке. Если поток Reclaimer
+// не удалось запустить, буфер освобождается сразу.
+// Пример: SimpleVector<uint64_t, DeferredFreeAllocator<HugePageAllocator>> table(size);
+template <typename Base = NewDeleteAllocator, size_t MinBytes = (size_t(1) << 20)>
+struct DeferredFreeAllocator {
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        return Base::template Allocate<Type>(size);
+    }
+
+    template <typename Type>
+    static Type* Reallocate(Type* data, size_t old_size, size_t new_size) noexcept {
+        if constexpr (array_detail::CanReallocate<Base, Type>::value) {
+            return Base::template Reallocate<Type>(data, old_size, new_size);
+        } else {
+            return nullptr;
+        }
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        if constexpr (std::is_trivially_destructible_v<Type>) {
+            if (size * sizeof(Type) >= MinBytes) {
+                if (Reclaimer* reclaimer = Reclaimer::TryInstance()) {
+                    reclaimer->Submit(&Release<Type>, data, size);
+                    return;
+                }
+            }
+        }
+        Base::Deallocate(data, size);
+    }
+
+private:
+    template <typename Type>
+    static void Release(void* data, size_t size) {
+        Base::Deallocate(static_cast<Type*>(data), size);
+    }
+};
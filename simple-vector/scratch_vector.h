@@ -0,0 +1,165 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <new>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Стек временных буферов потока: область REGION_BYTES байт, память из которой выдаётся
+// сдвигом вершины. Освобождение буфера на вершине сдвигает её обратно; буфер,
+// освобождённый не в порядке LIFO, возвращается, когда освобождены все буферы стека
+class ScratchStack {
+public:
+    static constexpr size_t REGION_BYTES = size_t(256) << 10;
+
+    ScratchStack(const ScratchStack&) = delete;
+    ScratchStack& operator=(const ScratchStack&) = delete;
+
+    // Область с живыми буферами не освобождается: они ещё могут к ней обратиться
+    ~ScratchStack() {
+        if (live_ == 0) {
+            ::operator delete(begin_);
+        }
+    }
+
+    // Стек текущего потока
+    static ScratchStack& Local() noexcept {
+        static thread_local ScratchStack stack;
+        return stack;
+    }
+
+    // Выделяет bytes байт с выравниванием alignment или возвращает nullptr, если стек исчерпан
+    void* TryAllocate(size_t bytes, size_t alignment) noexcept {
+        if (begin_ == nullptr) {
+            begin_ = static_cast<char*>(::operator new(REGION_BYTES, std::nothrow));
+            if (begin_ == nullptr) {
+                return nullptr;
+            }
+            top_ = begin_;
+            end_ = begin_ + REGION_BYTES;
+        }
+        const uintptr_t address = reinterpret_cast<uintptr_t>(top_);
+        char* first = top_ + ((alignment - address % alignment) % alignment);
+        if (first > end_ || bytes > static_cast<size_t>(end_ - first)) {
+            return nullptr;
+        }
+        top_ = first + RoundUp(bytes);
+        ++live_;
+        return first;
+    }
+
+    // Меняет длину буфера на вершине стека без переноса.
+    // Возвращает false, если data не на вершине или в области не хватает места
+    bool TryResize(void* data, size_t old_bytes, size_t new_bytes) noexcept {
+        char* first = static_cast<char*>(data);
+        if (first + RoundUp(old_bytes) != top_ || new_bytes > static_cast<size_t>(end_ - first)) {
+            return false;
+        }
+        top_ = first + RoundUp(new_bytes);
+        return true;
+    }
+
+    void Free(void* data, size_t bytes) noexcept {
+        TryResize(data, bytes, 0);
+        if (--live_ == 0) {
+            top_ = begin_;
+        }
+    }
+
+    // Занятая часть области, включая ещё не возвращённые буферы, освобождённые не по порядку
+    size_t GetUsedBytes() const noexcept {
+        return static_cast<size_t>(top_ - begin_);
+    }
+
+private:
+    ScratchStack() = default;
+
+    // Вершина остаётся выровненной, чтобы освобождение возвращало и отступ выравнивания
+    static size_t RoundUp(size_t bytes) noexcept {
+        constexpr size_t granule = alignof(std::max_align_t);
+        return (bytes + granule - 1) / granule * granule;
+    }
+
+    char* begin_ = nullptr;
+    char* top_ = nullptr;
+    char* end_ = nullptr;
+    size_t live_ = 0;
+};
+
+// Распределитель ArrayPtr из стека текущего потока; когда стек исчерпан — из кучи.
+// Перед массивом хранится указатель на его стек (nullptr для кучи). Буфер на вершине
+// стека растёт на месте. Освобождать буфер нужно в том же потоке, где он выделен
+struct ScratchAllocator {
+    template <typename Type>
+    static Type* Allocate(size_t size) {
+        constexpr size_t offset = HeaderOffset<Type>();
+        if (size > (SIZE_MAX - offset) / sizeof(Type)) {
+            throw std::bad_array_new_length();
+        }
+        const size_t bytes = offset + size * sizeof(Type);
+        ScratchStack* stack = &ScratchStack::Local();
+        char* memory = static_cast<char*>(stack->TryAllocate(bytes, offset));
+        if (memory == nullptr) {
+            stack = nullptr;
+            memory = static_cast<char*>(::operator new(bytes, std::align_val_t(offset)));
+        }
+        *HeaderOf(memory + offset) = stack;
+        try {
+            return array_detail::ConstructElements<Type>(memory + offset, size, false);
+        } catch (...) {
+            Free(memory + offset, offset, bytes);
+            throw;
+        }
+    }
+
+    template <typename Type>
+    static Type* Reallocate(Type* data, size_t old_size, size_t new_size) noexcept {
+        ScratchStack* stack = *HeaderOf(data);
+        if (stack == nullptr || new_size > SIZE_MAX / sizeof(Type)) {
+            return nullptr;
+        }
+        if (!stack->TryResize(data, old_size * sizeof(Type), new_size * sizeof(Type))) {
+            return nullptr;
+        }
+        try {
+            array_detail::ConstructElements<Type>(data + old_size, new_size - old_size, false);
+        } catch (...) {
+            stack->TryResize(data, new_size * sizeof(Type), old_size * sizeof(Type));
+            return nullptr;
+        }
+        return data;
+    }
+
+    template <typename Type>
+    static void Deallocate(Type* data, size_t size) noexcept {
+        array_detail::DestroyElements(data, size);
+        Free(data, HeaderOffset<Type>(), HeaderOffset<Type>() + size * sizeof(Type));
+    }
+
+private:
+    template <typename Type>
+    static constexpr size_t HeaderOffset() noexcept {
+        return std::max(alignof(Type), alignof(std::max_align_t));
+    }
+
+    static ScratchStack** HeaderOf(void* data) noexcept {
+        return reinterpret_cast<ScratchStack**>(static_cast<char*>(data) - sizeof(ScratchStack*));
+    }
+
+    // Возвращает выделение, у которого массив начинается с data, а заголовок занимает offset байт
+    static void Free(void* data, size_t offset, size_t bytes) noexcept {
+        char* memory = static_cast<char*>(data) - offset;
+        if (ScratchStack* stack = *HeaderOf(data); stack != nullptr) {
+            stack->Free(memory, bytes);
+        } else {
+            ::operator delete(memory, std::align_val_t(offset));
+        }
+    }
+};
+
+// Временный вектор на время одного вызова: выделение и освобождение стоят как сдвиг указателя
+template <typename Type>
+using ScratchVector = SimpleVector<Type, ScratchAllocator>;
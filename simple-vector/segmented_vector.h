@@ -0,0 +1,238 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+
+#include "array_ptr.h"
+#include "bit_utils.h"
+#include "index_iterator.h"
+#include "simple_vector.h"
+
+// Вектор из сегментов, каждый следующий из которых вдвое больше предыдущего.
+// При росте добавляется новый сегмент, а существующие элементы не перемещаются:
+// рост не вызывает пиков копирования, а указатели и ссылки на элементы остаются
+// действительными. Индексация — O(1) по старшему биту индекса
+template <typename Type>
+class SegmentedVector {
+public:
+    static constexpr size_t FIRST_SEGMENT_BITS = 4;
+
+    using Iterator = IndexIterator<SegmentedVector, Type>;
+    using ConstIterator = IndexIterator<const SegmentedVector, const Type>;
+
+    SegmentedVector() noexcept = default;
+
+    // Создаёт вектор из size элементов, инициализированных значением по умолчанию
+    explicit SegmentedVector(size_t size) {
+        Resize(size);
+    }
+
+    // Создаёт вектор из size элементов, инициализированных значением value
+    SegmentedVector(size_t size, const Type& value) {
+        Reserve(size);
+        for (size_t i = 0; i < size; ++i) {
+            PushBack(value);
+        }
+    }
+
+    explicit SegmentedVector(ReserveProxyObj capacity) {
+        Reserve(capacity);
+    }
+
+    // Создаёт вектор из std::initializer_list
+    SegmentedVector(std::initializer_list<Type> init) {
+        Reserve(init.size());
+        for (const Type& item : init) {
+            PushBack(item);
+        }
+    }
+
+    SegmentedVector(const SegmentedVector& other) {
+        Reserve(other.size_);
+        for (const Type& item : other) {
+            PushBack(item);
+        }
+    }
+
+    SegmentedVector(SegmentedVector&& other) noexcept {
+        swap(other);
+    }
+
+    SegmentedVector& operator=(const SegmentedVector& rhs) {
+        if (this != &rhs) {
+            SegmentedVector tmp(rhs);
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    SegmentedVector& operator=(SegmentedVector&& rhs) noexcept {
+        if (this != &rhs) {
+            SegmentedVector tmp(std::move(rhs));
+            swap(tmp);
+        }
+        return *this;
+    }
+
+    // Обменивает значение с другим вектором
+    void swap(SegmentedVector& other) noexcept {
+        for (size_t segment = 0; segment < Layout::MAX_SEGMENTS; ++segment) {
+            segments_[segment].swap(other.segments_[segment]);
+        }
+        std::swap(segment_count_, other.segment_count_);
+        std::swap(size_, other.size_);
+    }
+
+    // Возвращает количество элементов
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Возвращает суммарную вместимость выделенных сегментов
+    size_t GetCapacity() const noexcept {
+        return Layout::SegmentFirstIndex(segment_count_);
+    }
+
+    // Сообщает, пуст ли вектор
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    // Возвращает ссылку на элемент с индексом index
+    Type& operator[](size_t index) noexcept {
+        assert(index < size_);
+        return Slot(index);
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return const_cast<SegmentedVector*>(this)->Slot(index);
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    Type& At(size_t index) {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    const Type& At(size_t index) const {
+        if (index >= size_) {
+            throw std::out_of_range("out of range");
+        }
+        return (*this)[index];
+    }
+
+    // Обнуляет размер, не освобождая сегменты
+    void Clear() noexcept {
+        size_ = 0;
+    }
+
+    // Выделяет сегменты, пока вместимость не станет не меньше obj.size.
+    // Уже выделенные сегменты не перемещаются
+    void Reserve(const ReserveProxyObj& obj) {
+        while (GetCapacity() < obj.size) {
+            ArrayPtr<Type> segment(Layout::SegmentSize(segment_count_));
+            segments_[segment_count_].swap(segment);
+            ++segment_count_;
+        }
+    }
+
+    // Изменяет размер. Новые элементы инициализируются значением по умолчанию
+    void Resize(size_t new_size) {
+        Reserve(new_size);
+        for (size_t i = size_; i < new_size; ++i) {
+            Slot(i) = Type();
+        }
+        size_ = new_size;
+    }
+
+    // Добавляет элемент в конец. Ссылки на остальные элементы не инвалидируются
+    void PushBack(const Type& item) {
+        Reserve(size_ + 1);
+        Slot(size_++) = item;
+    }
+
+    void PushBack(Type&& item) {
+        Reserve(size_ + 1);
+        Slot(size_++) = std::move(item);
+    }
+
+    // "Удаляет" последний элемент. Для пустого вектора ничего не делает
+    void PopBack() noexcept {
+        if (size_ != 0) {
+            --size_;
+        }
+    }
+
+    Iterator begin() noexcept {
+        return Iterator(this, 0);
+    }
+
+    Iterator end() noexcept {
+        return Iterator(this, size_);
+    }
+
+    ConstIterator begin() const noexcept {
+        return ConstIterator(this, 0);
+    }
+
+    ConstIterator end() const noexcept {
+        return ConstIterator(this, size_);
+    }
+
+    ConstIterator cbegin() const noexcept {
+        return begin();
+    }
+
+    ConstIterator cend() const noexcept {
+        return end();
+    }
+
+private:
+    using Layout = GeometricSegments<FIRST_SEGMENT_BITS>;
+
+    // Ячейка с индексом index в пределах вместимости
+    Type& Slot(size_t index) noexcept {
+        const size_t segment = Layout::SegmentOf(index);
+        return segments_[segment][index - Layout::SegmentFirstIndex(segment)];
+    }
+
+    ArrayPtr<Type> segments_[Layout::MAX_SEGMENTS];
+    size_t segment_count_ = 0;
+    size_t size_ = 0;
+};
+
+template <typename Type>
+inline bool operator==(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator!=(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return !(lhs == rhs);
+}
+
+template <typename Type>
+inline bool operator<(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
+}
+
+template <typename Type>
+inline bool operator<=(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return !(rhs < lhs);
+}
+
+template <typename Type>
+inline bool operator>(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return rhs < lhs;
+}
+
+template <typename Type>
+inline bool operator>=(const SegmentedVector<Type>& lhs, const SegmentedVector<Type>& rhs) {
+    return !(lhs < rhs);
+}
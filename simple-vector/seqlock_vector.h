@@ -0,0 +1,125 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <thread>
+#include <type_traits>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Вектор фиксированного размера с одним писателем и многими читателями под seqlock.
+// Писатель никогда не ждёт читателей. Читатель повторяет чтение, если во время него
+// шла запись, поэтому всегда получает согласованные данные.
+// Элементы хранятся словами std::atomic<uint64_t>, чтобы одновременные чтение и запись
+// не были гонкой данных
+template <typename Type>
+class SeqlockVector {
+    static_assert(std::is_trivially_copyable_v<Type>, "SeqlockVector requires trivially copyable type");
+
+    using Word = uint64_t;
+    static constexpr size_t WORDS_PER_ITEM = (sizeof(Type) + sizeof(Word) - 1) / sizeof(Word);
+
+public:
+    explicit SeqlockVector(size_t size, const Type& value = Type())
+        : size_(size), words_(size * WORDS_PER_ITEM) {
+        for (size_t i = 0; i < size_; ++i) {
+            StoreItem(i, value);
+        }
+    }
+
+    SeqlockVector(const SeqlockVector&) = delete;
+    SeqlockVector& operator=(const SeqlockVector&) = delete;
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    // Записывает значение элемента. Вызывается только из потока-писателя
+    void Store(size_t index, const Type& value) noexcept {
+        assert(index < size_);
+        BeginWrite();
+        StoreItem(index, value);
+        EndWrite();
+    }
+
+    // Записывает все элементы одной транзакцией. Размер values должен совпадать с размером вектора
+    void Store(const SimpleVector<Type>& values) noexcept {
+        assert(values.GetSize() == size_);
+        BeginWrite();
+        for (size_t i = 0; i < size_; ++i) {
+            StoreItem(i, values[i]);
+        }
+        EndWrite();
+    }
+
+    // Возвращает значение элемента, записанное целиком
+    Type Load(size_t index) const noexcept {
+        assert(index < size_);
+        Type value;
+        ReadConsistent([&]() { value = LoadItem(index); });
+        return value;
+    }
+
+    // Копирует в out согласованный снимок всех элементов
+    void ReadInto(SimpleVector<Type>& out) const {
+        out.Resize(size_);
+        ReadConsistent([&]() {
+            for (size_t i = 0; i < size_; ++i) {
+                out[i] = LoadItem(i);
+            }
+        });
+    }
+
+private:
+    void BeginWrite() noexcept {
+        const size_t sequence = sequence_.load(std::memory_order_relaxed);
+        sequence_.store(sequence + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+    }
+
+    void EndWrite() noexcept {
+        sequence_.store(sequence_.load(std::memory_order_relaxed) + 1, std::memory_order_release);
+    }
+
+    // Выполняет read, пока оно не пройдёт целиком без параллельной записи
+    template <typename Read>
+    void ReadConsistent(Read read) const {
+        while (true) {
+            const size_t before = sequence_.load(std::memory_order_acquire);
+            if (before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            read();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (sequence_.load(std::memory_order_relaxed) == before) {
+                return;
+            }
+        }
+    }
+
+    void StoreItem(size_t index, const Type& value) noexcept {
+        Word buffer[WORDS_PER_ITEM] = {};
+        std::memcpy(buffer, &value, sizeof(Type));
+        for (size_t w = 0; w < WORDS_PER_ITEM; ++w) {
+            words_[index * WORDS_PER_ITEM + w].store(buffer[w], std::memory_order_relaxed);
+        }
+    }
+
+    Type LoadItem(size_t index) const noexcept {
+        Word buffer[WORDS_PER_ITEM];
+        for (size_t w = 0; w < WORDS_PER_ITEM; ++w) {
+            buffer[w] = words_[index * WORDS_PER_ITEM + w].load(std::memory_order_relaxed);
+        }
+        Type value;
+        std::memcpy(&value, buffer, sizeof(Type));
+        return value;
+    }
+
+    alignas(64) std::atomic<size_t> sequence_{0};
+    size_t size_;
+    ArrayPtr<std::atomic<Word>> words_;
+};
@@ -0,0 +1,262 @@
+#pragma once
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdint>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+#include <type_traits>
+
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "simple_vector.h"
+#include "span.h"
+
+// Двоичный формат SimpleVector для тривиально копируемых элементов:
+// заголовок фиксированной длины PAYLOAD_OFFSET байт, за которым без преобразований
+// лежат байты элементов. Смещение данных кратно 64, поэтому в отображённом в память
+// файле элементы выровнены и читаются на месте через VectorView.
+// Порядок байтов записывается в заголовок; данные с чужим порядком отвергаются
+namespace serialization_detail {
+
+constexpr uint8_t MAGIC[4] = {'S', 'V', 'E', 'C'};
+constexpr uint16_t VERSION = 1;
+constexpr uint8_t LITTLE_ENDIAN_MARK = 1;
+constexpr uint8_t BIG_ENDIAN_MARK = 2;
+constexpr size_t PAYLOAD_OFFSET = 64;
+// Порция чтения из каналов и сокетов: память растёт вместе с полученными данными
+constexpr size_t READ_CHUNK_BYTES = size_t(1) << 20;
+
+struct Header {
+    uint8_t magic[4];
+    uint16_t version;
+    uint8_t endianness;
+    uint8_t reserved;
+    uint32_t element_size;
+    uint32_t payload_offset;
+    uint64_t count;
+};
+
+static_assert(sizeof(Header) <= PAYLOAD_OFFSET);
+
+inline uint8_t NativeEndianness() noexcept {
+    const uint16_t probe = 1;
+    uint8_t first_byte = 0;
+    std::memcpy(&first_byte, &probe, 1);
+    return first_byte == 1 ? LITTLE_ENDIAN_MARK : BIG_ENDIAN_MARK;
+}
+
+// Проверяет заголовок и возвращает количество элементов
+inline uint64_t Validate(const Header& header, size_t element_size) {
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+        throw std::runtime_error("not a serialized vector");
+    }
+    if (header.version != VERSION) {
+        throw std::runtime_error("unsupported vector format version");
+    }
+    if (header.endianness != NativeEndianness()) {
+        throw std::runtime_error("vector was serialized with different byte order");
+    }
+    if (header.element_size != element_size) {
+        throw std::runtime_error("element size mismatch");
+    }
+    if (header.payload_offset != PAYLOAD_OFFSET) {
+        throw std::runtime_error("unexpected payload offset");
+    }
+    return header.count;
+}
+
+// Дописывает все буферы, продолжая после частичной записи (сокеты, каналы)
+inline void WriteAll(int fd, iovec* buffers, int count) {
+    while (count != 0) {
+        const ssize_t written = ::writev(fd, buffers, count);
+        if (written < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "writev");
+        }
+        size_t rest = static_cast<size_t>(written);
+        while (count != 0 && rest >= buffers->iov_len) {
+            rest -= buffers->iov_len;
+            ++buffers;
+            --count;
+        }
+        if (count != 0) {
+            buffers->iov_base = static_cast<char*>(buffers->iov_base) + rest;
+            buffers->iov_len -= rest;
+        }
+    }
+}
+
+// Читает ровно size байт. Обычно это один вызов read, повтор нужен только при коротком чтении
+inline void ReadAll(int fd, void* data, size_t size) {
+    char* position = static_cast<char*>(data);
+    while (size != 0) {
+        const ssize_t received = ::read(fd, position, size);
+        if (received < 0) {
+            if (errno == EINTR) {
+                continue;
+            }
+            throw std::system_error(errno, std::generic_category(), "read");
+        }
+        if (received == 0) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+        position += received;
+        size -= static_cast<size_t>(received);
+    }
+}
+
+// Для обычного файла записывает в bytes число байт от текущей позиции до конца и возвращает true.
+// Для каналов, сокетов и устройств возвращает false
+inline bool RemainingFileBytes(int fd, uint64_t& bytes) {
+    struct stat status;
+    if (::fstat(fd, &status) != 0) {
+        throw std::system_error(errno, std::generic_category(), "fstat");
+    }
+    if (!S_ISREG(status.st_mode)) {
+        return false;
+    }
+    const off_t position = ::lseek(fd, 0, SEEK_CUR);
+    if (position < 0) {
+        throw std::system_error(errno, std::generic_category(), "lseek");
+    }
+    bytes = position < status.st_size ? static_cast<uint64_t>(status.st_size - position) : 0;
+    return true;
+}
+
+}  // namespace serialization_detail
+
+// Возвращает размер представления count элементов в байтах
+template <typename Type>
+constexpr size_t SerializedSize(size_t count) noexcept {
+    return serialization_detail::PAYLOAD_OFFSET + count * sizeof(Type);
+}
+
+// Записывает вектор в файловый дескриптор одним вызовом writev прямо из буфера вектора
+template <typename Type, typename Allocator>
+void Save(int fd, const SimpleVector<Type, Allocator>& vector) {
+    static_assert(std::is_trivially_copyable_v<Type>, "Save requires trivially copyable type");
+    using namespace serialization_detail;
+
+    unsigned char prefix[PAYLOAD_OFFSET] = {};
+    Header header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.endianness = NativeEndianness();
+    header.element_size = sizeof(Type);
+    header.payload_offset = PAYLOAD_OFFSET;
+    header.count = vector.GetSize();
+    std::memcpy(prefix, &header, sizeof(header));
+
+    iovec buffers[2] = {
+        {prefix, sizeof(prefix)},
+        {const_cast<Type*>(vector.begin()), vector.GetSize() * sizeof(Type)},
+    };
+    WriteAll(fd, buffers, vector.IsEmpty() ? 1 : 2);
+}
+
+// Читает вектор, записанный Save. Выбрасывает std::runtime_error, если в заголовке больше
+// max_count элементов. Из обычного файла данные читаются одним вызовом read прямо в буфер
+// результата, после проверки, что файл содержит их целиком. Из каналов и сокетов — порциями
+// по READ_CHUNK_BYTES, чтобы испорченный заголовок не заставил выделить память впрок
+template <typename Type, typename Allocator = NewDeleteAllocator>
+SimpleVector<Type, Allocator> Load(int fd, size_t max_count = SIZE_MAX / sizeof(Type)) {
+    static_assert(std::is_trivially_copyable_v<Type>, "Load requires trivially copyable type");
+    using namespace serialization_detail;
+
+    unsigned char prefix[PAYLOAD_OFFSET];
+    ReadAll(fd, prefix, sizeof(prefix));
+    Header header;
+    std::memcpy(&header, prefix, sizeof(header));
+    const uint64_t count = Validate(header, sizeof(Type));
+    if (count > std::min<size_t>(max_count, SIZE_MAX / sizeof(Type))) {
+        throw std::runtime_error("serialized vector is too large");
+    }
+
+    size_t chunk = std::max<size_t>(READ_CHUNK_BYTES / sizeof(Type), 1);
+    if (uint64_t available = 0; RemainingFileBytes(fd, available)) {
+        if (count > available / sizeof(Type)) {
+            throw std::runtime_error("unexpected end of serialized vector");
+        }
+        chunk = static_cast<size_t>(count);
+    }
+    SimpleVector<Type, Allocator> result;
+    for (size_t loaded = 0; loaded < count;) {
+        const size_t portion = std::min(chunk, static_cast<size_t>(count) - loaded);
+        result.Resize(loaded + portion);
+        ReadAll(fd, result.begin() + loaded, portion * sizeof(Type));
+        loaded += portion;
+    }
+    return result;
+}
+
+// Представление сериализованного вектора в чужом буфере (например, отображённом файле).
+// Конструктор проверяет заголовок, длину и выравнивание; элементы не копируются
+template <typename Type>
+class VectorView {
+    static_assert(std::is_trivially_copyable_v<Type>, "VectorView requires trivially copyable type");
+
+public:
+    using ConstIterator = const Type*;
+
+    // Выбрасывает std::runtime_error, если буфер не содержит вектор элементов Type целиком
+    VectorView(const void* data, size_t size) {
+        using namespace serialization_detail;
+        if (size < PAYLOAD_OFFSET) {
+            throw std::runtime_error("buffer is too small for vector header");
+        }
+        Header header;
+        std::memcpy(&header, data, sizeof(header));
+        const uint64_t count = Validate(header, sizeof(Type));
+        if (count > (size - PAYLOAD_OFFSET) / sizeof(Type)) {
+            throw std::runtime_error("buffer is too small for vector payload");
+        }
+        const auto* payload = static_cast<const unsigned char*>(data) + PAYLOAD_OFFSET;
+        if (reinterpret_cast<uintptr_t>(payload) % alignof(Type) != 0) {
+            throw std::runtime_error("vector payload is misaligned");
+        }
+        items_ = Span<const Type>(reinterpret_cast<const Type*>(payload), static_cast<size_t>(count));
+    }
+
+    // Возвращает количество элементов
+    size_t GetSize() const noexcept {
+        return items_.GetSize();
+    }
+
+    // Сообщает, пуст ли вектор
+    bool IsEmpty() const noexcept {
+        return items_.IsEmpty();
+    }
+
+    const Type& operator[](size_t index) const noexcept {
+        return items_[index];
+    }
+
+    // Выбрасывает исключение std::out_of_range, если index >= size
+    const Type& At(size_t index) const {
+        if (index >= GetSize()) {
+            throw std::out_of_range("out of range");
+        }
+        return items_[index];
+    }
+
+    Span<const Type> AsSpan() const noexcept {
+        return items_;
+    }
+
+    ConstIterator begin() const noexcept {
+        return items_.begin();
+    }
+
+    ConstIterator end() const noexcept {
+        return items_.end();
+    }
+
+private:
+    Span<const Type> items_;
+};
@@ -1,29 +1,37 @@
 #pragma once
 
+#include <atomic>
 #include <cassert>
+#include <cstdint>
 #include <initializer_list>
 #include <stdexcept>
 #include <utility>
 #include <algorithm>
 
 #include "array_ptr.h"
+#include "prefault.h"
 
 class ReserveProxyObj{
 public:
-    ReserveProxyObj(size_t size) : size(size) {}
+    ReserveProxyObj(size_t size, PrefaultPolicy prefault = PrefaultPolicy::NONE) : size(size), prefault(prefault) {}
     size_t size = 0;
+    // Когда делать резидентными страницы зарезервированного буфера (учитывает SimpleVector)
+    PrefaultPolicy prefault = PrefaultPolicy::NONE;
 };
 
-ReserveProxyObj Reserve(size_t capacity_to_reserve) {
-    return ReserveProxyObj(capacity_to_reserve);
+ReserveProxyObj Reserve(size_t capacity_to_reserve, PrefaultPolicy prefault = PrefaultPolicy::NONE) {
+    return ReserveProxyObj(capacity_to_reserve, prefault);
 }
 
-template <typename Type>
+// Allocator задаёт, откуда берётся буфер вектора (см. NewDeleteAllocator в array_ptr.h)
+template <typename Type, typename Allocator = NewDeleteAllocator>
 class SimpleVector {
     size_t capacity = 0u;
     size_t size = 0u;
 
-    ArrayPtr<Type> array;
+    ArrayPtr<Type, Allocator> array;
+    // Фоновая подгрузка страниц array; объявлена после array, чтобы остановиться раньше его освобождения
+    PrefaultJob prefault_job;
 
 public:
     using Iterator = Type*;
@@ -41,7 +49,9 @@ public:
         std::fill(begin(), end(), value);
     }
 
-    explicit SimpleVector(ReserveProxyObj capacity) : capacity(capacity.size), array(capacity.size){ }
+    explicit SimpleVector(ReserveProxyObj capacity)
+        : capacity(capacity.size), array(capacity.size),
+          prefault_job(Prefault(array.Get(), capacity.size * sizeof(Type), capacity.prefault)) {}
 
     // Создаёт вектор из std::initializer_list
     SimpleVector(std::initializer_list<Type> init) : capacity(init.size()), size(init.size()), array(init.size()) {
@@ -57,25 +67,112 @@ public:
     }
 
     SimpleVector& operator=(const SimpleVector& rhs) {
-        SimpleVector<Type> tmp(rhs.size);
+        SimpleVector tmp(rhs.size);
         std::copy(rhs.begin(), rhs.end(), tmp.begin());
 
         swap(tmp);
-        capacity = rhs.capacity;
-        size = rhs.size;
 
         return *this;
     }
 
+    // Увеличивает вместимость до obj.size и подгружает добавленные страницы буфера согласно obj.prefault.
+    // Если вместимость уже не меньше obj.size, ничего не делает
     void Reserve(const ReserveProxyObj& obj){
-        if (obj.size < capacity){
+        if (obj.size <= capacity){
             return;
         }
-        SimpleVector<Type> tmp(obj.size);
-        std::move(begin(), end(), tmp.begin());
-        size_t old_size = size;
-        swap(tmp);
-        size = old_size;
+        // Фоновая подгрузка не должна работать с буфером, который переносится
+        prefault_job.Cancel();
+        size_t first_new = 0;
+        if (array.TryExtend(obj.size)) {
+            first_new = capacity;
+            capacity = obj.size;
+        } else {
+            // Хвост буфера не заполняется, чтобы его страницы подгружались только согласно obj.prefault
+            ArrayPtr<Type, Allocator> fresh(obj.size);
+            std::move(begin(), end(), fresh.Get());
+            array.swap(fresh);
+            capacity = obj.size;
+        }
+        prefault_job = Prefault(array.Get() + first_new, (capacity - first_new) * sizeof(Type), obj.prefault);
+    }
+
+    // Дескриптор параллельного заполнения места, зарезервированного ReserveForParallelWrite.
+    // Claim можно вызывать одновременно из разных потоков, Commit вызывается один раз
+    // после завершения всех записей. Пока дескриптор жив, вектор нельзя изменять
+    class ParallelWriter {
+    public:
+        // Непрерывный диапазон ячеек, выданный одному потоку
+        class SlotRange {
+        public:
+            SlotRange(Iterator first, Iterator last) noexcept : first_(first), last_(last) {}
+
+            Iterator begin() const noexcept {
+                return first_;
+            }
+
+            Iterator end() const noexcept {
+                return last_;
+            }
+
+            size_t GetSize() const noexcept {
+                return static_cast<size_t>(last_ - first_);
+            }
+
+            bool IsEmpty() const noexcept {
+                return first_ == last_;
+            }
+
+        private:
+            Iterator first_;
+            Iterator last_;
+        };
+
+        ParallelWriter(const ParallelWriter&) = delete;
+        ParallelWriter& operator=(const ParallelWriter&) = delete;
+
+        // Выдаёт до count ещё не занятых ячеек. Диапазоны, выданные разным вызовам, не пересекаются.
+        // Когда зарезервированное место заканчивается, диапазон укорачивается вплоть до пустого
+        SlotRange Claim(size_t count) noexcept {
+            // count сверяется с остатком до сдвига курсора, поэтому огромный count не переполняет его
+            size_t first = next_.load(std::memory_order_relaxed);
+            size_t taken = 0;
+            do {
+                taken = std::min(count, limit_ - first);
+            } while (!next_.compare_exchange_weak(first, first + taken, std::memory_order_relaxed));
+            Iterator base = vector_->begin() + offset_;
+            return SlotRange(base + first, base + first + taken);
+        }
+
+        // Делает частью вектора все выданные ячейки и возвращает новый размер вектора
+        size_t Commit() noexcept {
+            vector_->size = offset_ + next_.load(std::memory_order_acquire);
+            return vector_->size;
+        }
+
+    private:
+        friend class SimpleVector;
+
+        ParallelWriter(SimpleVector& vector, size_t count) noexcept
+            : vector_(&vector), offset_(vector.size), limit_(count) {}
+
+        SimpleVector* vector_;
+        size_t offset_;
+        size_t limit_;
+        std::atomic<size_t> next_{0};
+    };
+
+    // Резервирует место под count элементов за последним и возвращает дескриптор,
+    // через который потоки заполняют его без проверок вместимости и блокировок.
+    // Выбрасывает std::length_error, если size + count не помещается в size_t элементов Type
+    ParallelWriter ReserveForParallelWrite(size_t count) {
+        if (count > SIZE_MAX / sizeof(Type) - size) {
+            throw std::length_error("too many elements for parallel write");
+        }
+        if (size + count > capacity) {
+            Reserve(size + count);
+        }
+        return ParallelWriter(*this, count);
     }
 
     // Добавляет элемент в конец вектора
@@ -94,22 +191,19 @@ public:
     // вместимость вектора должна увеличиться вдвое, а для вектора вместимостью 0 стать равной 1
     Iterator Insert(ConstIterator pos, const Type& value) {
         assert(pos >= begin() && pos <= end());     // Нестрогое неравенство, т.к. может быть вставка в конец
-        Iterator iter = Iterator(pos);
-        Resize(size + 1);
-        std::move_backward(iter, end(), end() + 1);
-        *iter = value;
-//        ++size;
-        return iter;
+        const size_t index = static_cast<size_t>(pos - cbegin());
+        Type copy = value;      // value может ссылаться на элемент этого же вектора
+        Iterator position = MakeRoom(index);
+        *position = std::move(copy);
+        return position;
     }
 
-    Iterator Insert(Iterator pos, Type&& value) {
+    Iterator Insert(ConstIterator pos, Type&& value) {
         assert(pos >= begin() && pos <= end());     // Нестрогое неравенство, т.к. может быть вставка в конец
-        auto dist = std::distance(begin(), pos);
-        Resize(std::move(size + 1));
-        std::move_backward(std::make_move_iterator(begin() + dist), std::make_move_iterator(end() - 1), end());
-        std::exchange(*(begin() + dist), std::move(value));
-//        ++size;
-        return begin() + dist;
+        const size_t index = static_cast<size_t>(pos - cbegin());
+        Iterator position = MakeRoom(index);
+        *position = std::move(value);
+        return position;
     }
 
     // "Удаляет" последний элемент вектора. Вектор не должен быть пустым
@@ -129,18 +223,46 @@ public:
         return begin() + n;
     }
 
+    // Буфер вектора вместе с размером и вместимостью (см. DetachStorage)
+    struct Storage {
+        ArrayPtr<Type, Allocator> buffer;
+        size_t size = 0;
+        size_t capacity = 0;
+    };
+
+    // Создаёт вектор на готовом буфере без выделения памяти
+    explicit SimpleVector(Storage&& storage) noexcept {
+        AdoptStorage(std::move(storage));
+    }
+
+    // Забирает буфер вместе с элементами. Вектор становится пустым и без вместимости
+    Storage DetachStorage() noexcept {
+        prefault_job.Cancel();
+        Storage storage;
+        storage.buffer.swap(array);
+        storage.size = std::exchange(size, 0);
+        storage.capacity = std::exchange(capacity, 0);
+        return storage;
+    }
+
+    // Делает storage содержимым вектора. Прежний буфер освобождается, storage становится пустым
+    void AdoptStorage(Storage&& storage) noexcept {
+        assert(storage.size <= storage.capacity);
+        prefault_job.Cancel();
+        ArrayPtr<Type, Allocator> old_array(std::move(storage.buffer));
+        array.swap(old_array);
+        size = std::exchange(storage.size, 0);
+        capacity = std::exchange(storage.capacity, 0);
+    }
+
     // Обменивает значение с другим вектором
     void swap(SimpleVector& other) noexcept {
         array.swap(other.array);
+        prefault_job.swap(other.prefault_job);
         std::swap(size, other.size);
         std::swap(capacity, other.capacity);
     }
 
-    ~SimpleVector(){
-        delete array.Release();
-    }
-
-
     // Возвращает количество элементов в массиве
     size_t GetSize() const noexcept {
         return size;
@@ -197,16 +319,23 @@ public:
         if (new_size <= size) {
             size = new_size;
         } else {
-            if (new_size < capacity){
+            if (new_size <= capacity){
+                std::generate(begin() + size, begin() + new_size, [](){return Type();});
                 size = new_size;
             } else {
-                auto new_capacity = std::max(new_size, capacity * 2);
-                ArrayPtr<Type> new_items(new_capacity);
-                std::move(begin(), end(), new_items.Get());
-                std::generate(new_items.Get() + size, new_items.Get() + new_size, [](){return std::move(Type());});
+                prefault_job.Cancel();
+                const size_t new_capacity = std::max(new_size, capacity * 2);
+                if (array.TryExtend(new_capacity)) {
+                    // Буфер увеличен распределителем без переноса элементов
+                    std::generate(begin() + size, begin() + new_size, [](){return Type();});
+                } else {
+                    ArrayPtr<Type, Allocator> new_items(new_capacity);
+                    std::move(begin(), end(), new_items.Get());
+                    std::generate(new_items.Get() + size, new_items.Get() + new_size, [](){return std::move(Type());});
+                    array.swap(new_items);
+                }
                 capacity = new_capacity;
                 size = new_size;
-                array.swap(new_items);
             }
         }
     }
@@ -246,35 +375,46 @@ public:
     ConstIterator cend() const noexcept {
         return ConstIterator(array.Get() + size);
     }
+
+private:
+    // Увеличивает размер на 1 и сдвигает элементы начиная с index на одну позицию вправо.
+    // Возвращает итератор на освободившееся место; прежние итераторы после роста буфера недействительны
+    Iterator MakeRoom(size_t index) {
+        Resize(size + 1);
+        if (index + 1 < size) {
+            std::move_backward(begin() + index, end() - 1, end());
+        }
+        return begin() + index;
+    }
 };
 
-template <typename Type>
-inline bool operator==(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator==(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return std::equal(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <typename Type>
-inline bool operator!=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator!=(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return !(lhs == rhs);
 }
 
-template <typename Type>
-inline bool operator<(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator<(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return std::lexicographical_compare(lhs.begin(), lhs.end(), rhs.begin(), rhs.end());
 }
 
-template <typename Type>
-inline bool operator<=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator<=(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return (lhs == rhs) || (lhs < rhs);
 }
 
-template <typename Type>
-inline bool operator>(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator>(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return !(lhs <= rhs);
     return true;
 }
 
-template <typename Type>
-inline bool operator>=(const SimpleVector<Type>& lhs, const SimpleVector<Type>& rhs) {
+template <typename Type, typename Allocator>
+inline bool operator>=(const SimpleVector<Type, Allocator>& lhs, const SimpleVector<Type, Allocator>& rhs) {
     return !(lhs < rhs);
 }
@@ -0,0 +1,151 @@
+#pragma once
+
+#include <atomic>
+#include <cassert>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Вектор для данных, которые часто читаются и редко изменяются (по схеме RCU).
+// Читатели без ожидания получают ссылку на неизменяемый снимок, писатели строят
+// изменённую копию и атомарно публикуют её. Старый снимок удаляется после того,
+// как завершатся все читатели, которые могли его видеть
+template <typename Type>
+class SnapshotVector {
+    static constexpr size_t READER_SLOTS = 64;
+
+    // Счётчики активных читателей для двух чётностей эпохи.
+    // Потоки распределяются по слотам, чтобы не конкурировать за одну кэш-линию
+    struct alignas(64) ReaderSlot {
+        std::atomic<size_t> active[2] = {};
+    };
+
+public:
+    // Удерживает снимок, пока существует. Снимок не изменяется, даже если писатель
+    // за это время опубликовал новый. Внутри чтения нельзя вызывать Update того же вектора
+    class ReadGuard {
+    public:
+        ReadGuard(ReadGuard&& other) noexcept
+            : counter_(std::exchange(other.counter_, nullptr)), snapshot_(other.snapshot_) {}
+
+        ReadGuard(const ReadGuard&) = delete;
+        ReadGuard& operator=(const ReadGuard&) = delete;
+        ReadGuard& operator=(ReadGuard&&) = delete;
+
+        ~ReadGuard() {
+            if (counter_ != nullptr) {
+                counter_->fetch_sub(1, std::memory_order_release);
+            }
+        }
+
+        const SimpleVector<Type>& Get() const noexcept {
+            return *snapshot_;
+        }
+
+        const SimpleVector<Type>* operator->() const noexcept {
+            return snapshot_;
+        }
+
+        const Type& operator[](size_t index) const noexcept {
+            return (*snapshot_)[index];
+        }
+
+        size_t GetSize() const noexcept {
+            return snapshot_->GetSize();
+        }
+
+        typename SimpleVector<Type>::ConstIterator begin() const noexcept {
+            return snapshot_->begin();
+        }
+
+        typename SimpleVector<Type>::ConstIterator end() const noexcept {
+            return snapshot_->end();
+        }
+
+    private:
+        friend class SnapshotVector;
+
+        ReadGuard(std::atomic<size_t>* counter, const SimpleVector<Type>* snapshot) noexcept
+            : counter_(counter), snapshot_(snapshot) {}
+
+        std::atomic<size_t>* counter_;
+        const SimpleVector<Type>* snapshot_;
+    };
+
+    SnapshotVector() : SnapshotVector(SimpleVector<Type>()) {}
+
+    explicit SnapshotVector(SimpleVector<Type> initial)
+        : current_(new SimpleVector<Type>(std::move(initial))) {}
+
+    SnapshotVector(const SnapshotVector&) = delete;
+    SnapshotVector& operator=(const SnapshotVector&) = delete;
+
+    // Не должен вызываться, пока существуют ReadGuard этого вектора
+    ~SnapshotVector() {
+        delete current_.load();
+    }
+
+    // Без ожидания захватывает текущий снимок
+    ReadGuard Read() const noexcept {
+        const size_t parity = epoch_.load(std::memory_order_relaxed) & 1;
+        std::atomic<size_t>* counter = &slots_[ThreadSlot()].active[parity];
+        counter->fetch_add(1, std::memory_order_seq_cst);
+        return ReadGuard(counter, current_.load(std::memory_order_seq_cst));
+    }
+
+    // Возвращает копию текущего снимка
+    SimpleVector<Type> Load() const {
+        return Read().Get();
+    }
+
+    // Публикует новое содержимое и дожидается освобождения старого снимка
+    void Store(SimpleVector<Type> value) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        Publish(new SimpleVector<Type>(std::move(value)));
+    }
+
+    // Применяет func к копии текущего снимка и публикует результат.
+    // Писатели выполняются по одному, читатели при этом не блокируются
+    template <typename Func>
+    void Update(Func func) {
+        std::lock_guard<std::mutex> lock(writer_mutex_);
+        auto* next = new SimpleVector<Type>(*current_.load(std::memory_order_relaxed));
+        try {
+            func(*next);
+        } catch (...) {
+            delete next;
+            throw;
+        }
+        Publish(next);
+    }
+
+private:
+    static size_t ThreadSlot() noexcept {
+        static thread_local const size_t slot = std::hash<std::thread::id>()(std::this_thread::get_id()) % READER_SLOTS;
+        return slot;
+    }
+
+    // Заменяет снимок и ждёт окончания периода ожидания (grace period): каждый читатель,
+    // увидевший старый снимок, успел увеличить один из счётчиков до его замены.
+    // Смена эпохи направляет новых читателей в другую чётность, поэтому ожидание конечно
+    void Publish(SimpleVector<Type>* next) {
+        SimpleVector<Type>* old = current_.exchange(next, std::memory_order_seq_cst);
+        for (int phase = 0; phase < 2; ++phase) {
+            const size_t parity = epoch_.fetch_add(1, std::memory_order_seq_cst) & 1;
+            for (size_t slot = 0; slot < READER_SLOTS; ++slot) {
+                while (slots_[slot].active[parity].load(std::memory_order_acquire) != 0) {
+                    std::this_thread::yield();
+                }
+            }
+        }
+        delete old;
+    }
+
+    std::atomic<SimpleVector<Type>*> current_;
+    std::atomic<size_t> epoch_{0};
+    mutable ReaderSlot slots_[READER_SLOTS];
+    std::mutex writer_mutex_;
+};
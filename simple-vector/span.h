@@ -0,0 +1,42 @@
+#pragma once
+
+#include <cassert>
+#include <cstddef>
+
+// Невладеющее представление непрерывного участка памяти
+template <typename Type>
+class Span {
+public:
+    Span() noexcept = default;
+
+    Span(Type* data, size_t size) noexcept : data_(data), size_(size) {}
+
+    Type* Data() const noexcept {
+        return data_;
+    }
+
+    size_t GetSize() const noexcept {
+        return size_;
+    }
+
+    bool IsEmpty() const noexcept {
+        return size_ == 0;
+    }
+
+    Type& operator[](size_t index) const noexcept {
+        assert(index < size_);
+        return data_[index];
+    }
+
+    Type* begin() const noexcept {
+        return data_;
+    }
+
+    Type* end() const noexcept {
+        return data_ + size_;
+    }
+
+private:
+    Type* data_ = nullptr;
+    size_t size_ = 0;
+};
@@ -0,0 +1,103 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <utility>
+
+#include "array_ptr.h"
+#include "bit_utils.h"
+
+// Неблокирующая кольцевая очередь для одного производителя и одного потребителя.
+// Индексы чтения и записи лежат в разных кэш-линиях, и каждая сторона хранит
+// закэшированную копию чужого индекса, поэтому обращается к нему только при
+// видимом переполнении или опустошении
+template <typename Type>
+class SpscRing {
+    static constexpr size_t CACHE_LINE = 64;
+
+public:
+    // Вместимость округляется вверх до степени двойки
+    explicit SpscRing(size_t capacity)
+        : capacity_(RoundUpToPowerOfTwo(capacity)), mask_(capacity_ - 1), buffer_(capacity_) {}
+
+    SpscRing(const SpscRing&) = delete;
+    SpscRing& operator=(const SpscRing&) = delete;
+
+    size_t GetCapacity() const noexcept {
+        return capacity_;
+    }
+
+    // Приблизительное число элементов: точно только при отсутствии параллельных операций
+    size_t GetSize() const noexcept {
+        return tail_.load(std::memory_order_acquire) - head_.load(std::memory_order_acquire);
+    }
+
+    bool IsEmpty() const noexcept {
+        return GetSize() == 0;
+    }
+
+    // Методы производителя. Возвращают false, если очередь заполнена
+    bool TryPush(const Type& item) {
+        return PushN(&item, 1) == 1;
+    }
+
+    bool TryPush(Type&& item) {
+        return PushN(std::make_move_iterator(&item), 1) == 1;
+    }
+
+    // Копирует (или перемещает для move_iterator) до count элементов начиная с first
+    // и публикует их одной атомарной записью. Возвращает количество добавленных элементов
+    template <typename InputIt>
+    size_t PushN(InputIt first, size_t count) {
+        const size_t tail = tail_.load(std::memory_order_relaxed);
+        if (capacity_ - (tail - cached_head_) < count) {
+            cached_head_ = head_.load(std::memory_order_acquire);
+        }
+        count = std::min(count, capacity_ - (tail - cached_head_));
+        for (size_t i = 0; i < count; ++i, ++first) {
+            buffer_[(tail + i) & mask_] = *first;
+        }
+        if (count != 0) {
+            tail_.store(tail + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+    // Методы потребителя. Возвращают false, если очередь пуста
+    bool TryPop(Type& item) {
+        return PopN(&item, 1) == 1;
+    }
+
+    // Перемещает до max_count элементов в out и освобождает их ячейки одной атомарной записью.
+    // Возвращает количество извлечённых элементов
+    template <typename OutputIt>
+    size_t PopN(OutputIt out, size_t max_count) {
+        const size_t head = head_.load(std::memory_order_relaxed);
+        if (cached_tail_ - head < max_count) {
+            cached_tail_ = tail_.load(std::memory_order_acquire);
+        }
+        const size_t count = std::min(max_count, cached_tail_ - head);
+        for (size_t i = 0; i < count; ++i, ++out) {
+            *out = std::move(buffer_[(head + i) & mask_]);
+        }
+        if (count != 0) {
+            head_.store(head + count, std::memory_order_release);
+        }
+        return count;
+    }
+
+private:
+    const size_t capacity_;
+    const size_t mask_;
+    ArrayPtr<Type> buffer_;
+
+    // Данные потребителя
+    alignas(CACHE_LINE) std::atomic<size_t> head_{0};
+    size_t cached_tail_ = 0;
+
+    // Данные производителя
+    alignas(CACHE_LINE) std::atomic<size_t> tail_{0};
+    size_t cached_head_ = 0;
+
+    char padding_[CACHE_LINE - sizeof(std::atomic<size_t>) - sizeof(size_t)] = {};
+};
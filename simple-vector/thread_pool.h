@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <condition_variable>
+#include <cstdint>
+#include <deque>
+#include <exception>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <thread>
+#include <utility>
+
+#include "array_ptr.h"
+#include "simple_vector.h"
+
+// Дек задач одного рабочего потока (алгоритм Chase-Lev).
+// Владелец кладёт и забирает задачи с "нижнего" конца без блокировок,
+// остальные потоки крадут задачи с "верхнего" конца через CAS
+template <typename Type>
+class WorkStealingDeque {
+public:
+    // capacity должна быть степенью двойки
+    explicit WorkStealingDeque(size_t capacity) : mask_(capacity - 1), buffer_(capacity) {
+        assert(capacity != 0 && (capacity & (capacity - 1)) == 0);
+    }
+
+    WorkStealingDeque(const WorkStealingDeque&) = delete;
+    WorkStealingDeque& operator=(const WorkStealingDeque&) = delete;
+
+    // Вызывается только владельцем. Возвращает false, если дек заполнен
+    bool Push(Type* item) noexcept {
+        const int64_t b = bottom_.load(std::memory_order_relaxed);
+        const int64_t t = top_.load(std::memory_order_acquire);
+        if (b - t > static_cast<int64_t>(mask_)) {
+            return false;
+        }
+        buffer_[b & mask_].store(item, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        bottom_.store(b + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    // Вызывается только владельцем. Забирает последнюю добавленную задачу либо возвращает nullptr
+    Type* Pop() noexcept {
+        const int64_t b = bottom_.load(std::memory_order_relaxed) - 1;
+        bottom_.store(b, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        int64_t t = top_.load(std::memory_order_relaxed);
+        if (t > b) {
+            bottom_.store(b + 1, std::memory_order_relaxed);
+            return nullptr;
+        }
+        Type* item = buffer_[b & mask_].load(std::memory_order_relaxed);
+        if (t == b) {
+            // Последний элемент: соревнуемся с ворами
+            if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+                item = nullptr;
+            }
+            bottom_.store(b + 1, std::memory_order_relaxed);
+        }
+        return item;
+    }
+
+    // Может вызываться из любого потока. Возвращает nullptr, если дек пуст или кража не удалась
+    Type* Steal() noexcept {
+        int64_t t = top_.load(std::memory_order_acquire);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        const int64_t b = bottom_.load(std::memory_order_acquire);
+        if (t >= b) {
+            return nullptr;
+        }
+        Type* item = buffer_[t & mask_].load(std::memory_order_relaxed);
+        if (!top_.compare_exchange_strong(t, t + 1, std::memory_order_seq_cst, std::memory_order_relaxed)) {
+            return nullptr;
+        }
+        return item;
+    }
+
+private:
+    alignas(64) std::atomic<int64_t> top_{0};
+    alignas(64) std::atomic<int64_t> bottom_{0};
+    size_t mask_;
+    ArrayPtr<std::atomic<Type*>> buffer_;
+};
+
+// Пул потоков с перехватом работы (work stealing).
+// Каждый рабочий поток обслуживает свой дек задач, простаивающие потоки
+// крадут задачи у соседей. Задачи из внешних потоков попадают в общую очередь
+class ThreadPool {
+    struct Task {
+        std::function<void()> func;
+    };
+
+public:
+    static constexpr size_t DEQUE_CAPACITY = 1024;
+
+    explicit ThreadPool(size_t thread_count = DefaultThreadCount())
+        : worker_count_(std::max<size_t>(thread_count, 1u)), deques_(worker_count_), threads_(worker_count_) {
+        for (size_t i = 0; i < worker_count_; ++i) {
+            deques_[i] = std::make_unique<WorkStealingDeque<Task>>(DEQUE_CAPACITY);
+        }
+        for (size_t i = 0; i < worker_count_; ++i) {
+            threads_[i] = std::thread([this, i]() { WorkerLoop(i); });
+        }
+    }
+
+    ThreadPool(const ThreadPool&) = delete;
+    ThreadPool& operator=(const ThreadPool&) = delete;
+
+    // Дожидается выполнения всех поставленных задач и останавливает потоки
+    ~ThreadPool() {
+        {
+            std::lock_guard<std::mutex> lock(sleep_mutex_);
+            stop_ = true;
+        }
+        sleep_cv_.notify_all();
+        for (size_t i = 0; i < worker_count_; ++i) {
+            threads_[i].join();
+        }
+    }
+
+    // Общий для всех параллельных алгоритмов планировщик
+    static ThreadPool& Instance() {
+        static ThreadPool pool;
+        return pool;
+    }
+
+    static size_t DefaultThreadCount() noexcept {
+        return std::max<size_t>(std::thread::hardware_concurrency(), 1u);
+    }
+
+    size_t GetThreadCount() const noexcept {
+        return worker_count_;
+    }
+
+    // Ставит задачу в очередь. Из рабочего потока задача кладётся в его собственный дек
+    template <typename Func>
+    void Submit(Func func) {
+        Task* task = new Task{std::function<void()>(std::move(func))};
+        queued_.fetch_add(1);
+        if (current_pool_ != this || !deques_[current_index_]->Push(task)) {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            injected_.push_back(task);
+        }
+        if (sleeping_.load() != 0) {
+            { std::lock_guard<std::mutex> lock(sleep_mutex_); }
+            sleep_cv_.notify_one();
+        }
+    }
+
+    // Выполняет одну ожидающую задачу, если она есть.
+    // Используется ожидающими потоками, чтобы помогать пулу вместо простоя.
+    // Исключение из задачи не выходит наружу, а сохраняется (см. TakeError)
+    bool TryRunPendingTask() {
+        Task* task = TakeTask();
+        if (task == nullptr) {
+            return false;
+        }
+        queued_.fetch_sub(1);
+        TaskGuard guard(task);
+        try {
+            task->func();
+        } catch (...) {
+            std::lock_guard<std::mutex> lock(error_mutex_);
+            if (!error_) {
+                error_ = std::current_exception();
+            }
+        }
+        return true;
+    }
+
+    // Возвращает первое исключение, выброшенное задачей из Submit, и забывает его.
+    // Если задачи завершились без исключений, возвращает пустой указатель
+    std::exception_ptr TakeError() {
+        std::lock_guard<std::mutex> lock(error_mutex_);
+        return std::exchange(error_, nullptr);
+    }
+
+private:
+    // Удаляет задачу даже при выходе по исключению
+    struct TaskGuard {
+        explicit TaskGuard(Task* task) : task(task) {}
+        ~TaskGuard() { delete task; }
+        Task* task;
+    };
+
+    Task* TakeTask() {
+        const bool is_worker = current_pool_ == this;
+        if (is_worker) {
+            if (Task* task = deques_[current_index_]->Pop()) {
+                return task;
+            }
+        }
+        if (queued_.load(std::memory_order_relaxed) == 0) {
+            return nullptr;
+        }
+        {
+            std::lock_guard<std::mutex> lock(inject_mutex_);
+            if (!injected_.empty()) {
+                Task* task = injected_.front();
+                injected_.pop_front();
+                return task;
+            }
+        }
+        const size_t start = is_worker ? current_index_ + 1 : 0;
+        for (size_t i = 0; i < worker_count_; ++i) {
+            if (Task* task = deques_[(start + i) % worker_count_]->Steal()) {
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void WorkerLoop(size_t index) {
+        current_pool_ = this;
+        current_index_ = index;
+        while (true) {
+            if (TryRunPendingTask()) {
+                continue;
+            }
+            std::unique_lock<std::mutex> lock(sleep_mutex_);
+            if (stop_ && queued_.load() == 0) {
+                break;
+            }
+            sleeping_.fetch_add(1);
+            sleep_cv_.wait(lock, [this]() { return stop_ || queued_.load() != 0; });
+            sleeping_.fetch_sub(1);
+        }
+    }
+
+    inline static thread_local ThreadPool* current_pool_ = nullptr;
+    inline static thread_local size_t current_index_ = 0;
+
+    size_t worker_count_;
+    ArrayPtr<std::unique_ptr<WorkStealingDeque<Task>>> deques_;
+    ArrayPtr<std::thread> threads_;
+
+    std::mutex inject_mutex_;
+    std::deque<Task*> injected_;
+
+    std::atomic<size_t> queued_{0};
+    std::atomic<size_t> sleeping_{0};
+    std::mutex sleep_mutex_;
+    std::condition_variable sleep_cv_;
+    bool stop_ = false;
+
+    std::mutex error_mutex_;
+    std::exception_ptr error_;
+};
+
+namespace parallel_detail {
+
+// Общее состояние одного параллельного цикла: счётчик незавершённых задач
+// и первое выброшенное исключение
+struct LoopState {
+    std::atomic<size_t> pending{1};
+    std::atomic<bool> failed{false};
+    std::exception_ptr error;
+};
+
+// Рекурсивно делит диапазон блоков [first, last) пополам, отдавая правую половину
+// пулу, пока не останется один блок, и вызывает для него body(block)
+template <typename Body>
+void RunBlocks(ThreadPool& pool, LoopState& state, size_t first, size_t last, const Body& body) {
+    while (last - first > 1) {
+        const size_t mid = first + (last - first) / 2;
+        state.pending.fetch_add(1);
+        pool.Submit([&pool, &state, mid, last, &body]() { RunBlocks(pool, state, mid, last, body); });
+        last = mid;
+    }
+    if (!state.failed.load(std::memory_order_relaxed)) {
+        try {
+            body(first);
+        } catch (...) {
+            if (!state.failed.exchange(true)) {
+                state.error = std::current_exception();
+            }
+        }
+    }
+    state.pending.fetch_sub(1, std::memory_order_release);
+}
+
+// Выполняет body(block) для каждого блока из [0, block_count), помогая пулу до завершения
+template <typename Body>
+void ForEachBlock(size_t block_count, const Body& body) {
+    if (block_count == 0) {
+        return;
+    }
+    ThreadPool& pool = ThreadPool::Instance();
+    LoopState state;
+    RunBlocks(pool, state, 0, block_count, body);
+    while (state.pending.load(std::memory_order_acquire) != 0) {
+        if (!pool.TryRunPendingTask()) {
+            std::this_thread::yield();
+        }
+    }
+    if (state.error) {
+        std::rethrow_exception(state.error);
+    }
+}
+
+// Не переполняется при grain, близком к SIZE_MAX
+inline size_t BlockCount(size_t size, size_t grain) noexcept {
+    return size / grain + (size % grain != 0);
+}
+
+} // namespace parallel_detail
+
+// Вызывает func(first, last) для непересекающихся диапазонов индексов из [0, size),
+// каждый длиной не больше grain. Диапазоны выполняются параллельно в общем пуле.
+// Исключение, выброшенное func, пробрасывается вызывающему после завершения цикла
+template <typename Func>
+void ParallelFor(size_t size, size_t grain, Func func) {
+    grain = std::max<size_t>(grain, 1u);
+    parallel_detail::ForEachBlock(parallel_detail::BlockCount(size, grain), [&](size_t block) {
+        const size_t first = block * grain;
+        func(first, first + std::min(grain, size - first));
+    });
+}
+
+template <typename Type, typename Allocator, typename Func>
+void ParallelFor(const SimpleVector<Type, Allocator>& vec, size_t grain, Func func) {
+    ParallelFor(vec.GetSize(), grain, std::move(func));
+}
+
+// Вычисляет func(first, last) для диапазонов длиной grain и сворачивает частичные
+// результаты слева направо через combine, начиная с init.
+// Разбиение не зависит от числа потоков, поэтому результат детерминирован.
+// Result не обязан иметь конструктор по умолчанию
+template <typename Type, typename Allocator, typename Result, typename Func, typename Combine>
+Result ParallelReduce(const SimpleVector<Type, Allocator>& vec, size_t grain, Result init, Func func, Combine combine) {
+    grain = std::max<size_t>(grain, 1u);
+    const size_t size = vec.GetSize();
+    const size_t block_count = parallel_detail::BlockCount(size, grain);
+    SimpleVector<std::optional<Result>> partial(block_count);
+    parallel_detail::ForEachBlock(block_count, [&](size_t block) {
+        const size_t first = block * grain;
+        partial[block].emplace(func(first, first + std::min(grain, size - first)));
+    });
+    for (size_t block = 0; block < block_count; ++block) {
+        init = combine(std::move(init), std::move(*partial[block]));
+    }
+    return init;
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <mutex>
+#include <utility>
+
+#include "simple_vector.h"
+
+// Пул векторов для передачи буферов между стадиями обработки без выделения памяти.
+// Acquire выдаёт пустой вектор, по возможности с буфером ранее возвращённого вектора,
+// Release принимает вектор обратно. Элементы возвращённых векторов не разрушаются
+// до повторного использования буфера. Методы можно вызывать из разных потоков
+template <typename Type, typename Allocator = NewDeleteAllocator>
+class VectorRecycler {
+public:
+    using Vector = SimpleVector<Type, Allocator>;
+
+    static constexpr size_t DEFAULT_MAX_CACHED = 16;
+
+    // Хранит не больше max_cached буферов; лишние освобождаются
+    explicit VectorRecycler(size_t max_cached = DEFAULT_MAX_CACHED) : max_cached_(max_cached) {}
+
+    VectorRecycler(const VectorRecycler&) = delete;
+    VectorRecycler& operator=(const VectorRecycler&) = delete;
+
+    // Выдаёт пустой вектор вместимостью не меньше min_capacity
+    Vector Acquire(size_t min_capacity = 0) {
+        Vector result;
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            if (!cached_.IsEmpty()) {
+                result.AdoptStorage(std::move(cached_[cached_.GetSize() - 1]));
+                cached_.PopBack();
+            }
+        }
+        if (min_capacity > result.GetCapacity()) {
+            result.Reserve(min_capacity);
+        }
+        return result;
+    }
+
+    // Забирает буфер вектора в пул. Вектор становится пустым
+    void Release(Vector&& vector) {
+        if (vector.GetCapacity() == 0) {
+            return;
+        }
+        vector.Clear();
+        auto storage = vector.DetachStorage();
+        std::lock_guard<std::mutex> lock(mutex_);
+        if (cached_.GetSize() < max_cached_) {
+            cached_.PushBack(std::move(storage));
+        }
+    }
+
+    // Количество буферов, ожидающих повторного использования
+    size_t GetCachedCount() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return cached_.GetSize();
+    }
+
+private:
+    const size_t max_cached_;
+    mutable std::mutex mutex_;
+    SimpleVector<typename Vector::Storage> cached_;
+};
@@ -0,0 +1,472 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cerrno>
+#include <condition_variable>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <istream>
+#include <mutex>
+#include <ostream>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+#include <type_traits>
+
+#include <poll.h>
+#include <sys/uio.h>
+#include <unistd.h>
+
+#include "array_ptr.h"
+#include "serialization.h"
+#include "simple_vector.h"
+
+// Потоковый формат для векторов, которые неудобно писать и читать одной операцией:
+// заголовок потока, затем блоки (chunks) не длиннее chunk_size элементов. Перед каждым
+// блоком записаны количество элементов и контрольная сумма его байтов, поэтому
+// повреждённый блок обнаруживается сразу при чтении. Поток завершается пустым блоком
+namespace stream_detail {
+
+constexpr uint8_t MAGIC[4] = {'S', 'V', 'S', 'T'};
+constexpr uint16_t VERSION = 1;
+// Наибольший допустимый блок: длина из заголовка потока не может заставить выделить больше
+constexpr size_t MAX_CHUNK_BYTES = size_t(64) << 20;
+
+struct StreamHeader {
+    uint8_t magic[4];
+    uint16_t version;
+    uint8_t endianness;
+    uint8_t reserved;
+    uint32_t element_size;
+    uint32_t reserved2;
+    uint64_t chunk_size;
+};
+
+struct ChunkHeader {
+    uint64_t count;
+    uint64_t checksum;
+};
+
+// Контрольная сумма по 8-байтовым словам. Каждый шаг обратим, поэтому
+// изменение любого одного слова всегда меняет результат
+inline uint64_t Checksum(const void* data, size_t size) noexcept {
+    constexpr uint64_t PRIME = 0x100000001b3;
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    uint64_t hash = 0xcbf29ce484222325 ^ size;
+    size_t offset = 0;
+    for (; offset + sizeof(uint64_t) <= size; offset += sizeof(uint64_t)) {
+        uint64_t word;
+        std::memcpy(&word, bytes + offset, sizeof(word));
+        hash = (hash ^ word) * PRIME;
+        hash ^= hash >> 32;
+    }
+    if (offset != size) {
+        uint64_t word = 0;
+        std::memcpy(&word, bytes + offset, size - offset);
+        hash = (hash ^ word) * PRIME;
+        hash ^= hash >> 32;
+    }
+    return hash;
+}
+
+// Приёмник байтов: файловый дескриптор или std::ostream
+class Output {
+public:
+    explicit Output(int fd) noexcept : fd_(fd) {}
+    explicit Output(std::ostream& stream) noexcept : stream_(&stream) {}
+
+    void Write(iovec* buffers, int count) {
+        if (stream_ == nullptr) {
+            serialization_detail::WriteAll(fd_, buffers, count);
+            return;
+        }
+        for (int i = 0; i < count; ++i) {
+            stream_->write(static_cast<const char*>(buffers[i].iov_base), static_cast<std::streamsize>(buffers[i].iov_len));
+        }
+        if (!*stream_) {
+            throw std::runtime_error("vector stream write failed");
+        }
+    }
+
+private:
+    int fd_ = -1;
+    std::ostream* stream_ = nullptr;
+};
+
+// Источник байтов: файловый дескриптор или std::istream.
+// Чтение из дескриптора можно прервать записью в wake_fd (см. SetWakeFd)
+class Input {
+public:
+    explicit Input(int fd) noexcept : fd_(fd) {}
+    explicit Input(std::istream& stream) noexcept : stream_(&stream) {}
+
+    bool IsDescriptor() const noexcept {
+        return stream_ == nullptr;
+    }
+
+    // Перед каждым read ждёт данных через poll одновременно с wake_fd. Когда wake_fd
+    // становится доступен для чтения, Read выбрасывает std::runtime_error
+    void SetWakeFd(int wake_fd) noexcept {
+        wake_fd_ = wake_fd;
+    }
+
+    void Read(void* data, size_t size) {
+        if (stream_ == nullptr) {
+            if (wake_fd_ < 0) {
+                serialization_detail::ReadAll(fd_, data, size);
+            } else {
+                ReadInterruptible(static_cast<char*>(data), size);
+            }
+            return;
+        }
+        stream_->read(static_cast<char*>(data), static_cast<std::streamsize>(size));
+        if (static_cast<size_t>(stream_->gcount()) != size) {
+            throw std::runtime_error("unexpected end of vector stream");
+        }
+    }
+
+private:
+    void ReadInterruptible(char* data, size_t size) {
+        while (size != 0) {
+            pollfd fds[2] = {{fd_, POLLIN, 0}, {wake_fd_, POLLIN, 0}};
+            if (::poll(fds, 2, -1) < 0) {
+                if (errno == EINTR) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "poll");
+            }
+            if (fds[1].revents != 0) {
+                throw std::runtime_error("vector stream reading interrupted");
+            }
+            const ssize_t received = ::read(fd_, data, size);
+            if (received < 0) {
+                if (errno == EINTR || errno == EAGAIN) {
+                    continue;
+                }
+                throw std::system_error(errno, std::generic_category(), "read");
+            }
+            if (received == 0) {
+                throw std::runtime_error("unexpected end of vector stream");
+            }
+            data += received;
+            size -= static_cast<size_t>(received);
+        }
+    }
+
+    int fd_ = -1;
+    int wake_fd_ = -1;
+    std::istream* stream_ = nullptr;
+};
+
+}  // namespace stream_detail
+
+// Записывает элементы потоком блоков фиксированной длины. Полные блоки из длинных
+// массивов пишутся прямо из памяти вызывающего, остаток накапливается во внутреннем буфере.
+// Поток нужно завершить вызовом Finish; деструктор делает это сам, но глотает ошибки
+template <typename Type>
+class VectorWriter {
+    static_assert(std::is_trivially_copyable_v<Type>, "VectorWriter requires trivially copyable type");
+
+public:
+    static constexpr size_t DEFAULT_CHUNK_BYTES = size_t(1) << 20;
+    static constexpr size_t DEFAULT_CHUNK_SIZE = std::max<size_t>(DEFAULT_CHUNK_BYTES / sizeof(Type), 1);
+    static constexpr size_t MAX_CHUNK_SIZE = std::max<size_t>(stream_detail::MAX_CHUNK_BYTES / sizeof(Type), 1);
+
+    // chunk_size ограничивается MAX_CHUNK_SIZE, чтобы поток можно было прочитать
+    explicit VectorWriter(int fd, size_t chunk_size = DEFAULT_CHUNK_SIZE) : VectorWriter(stream_detail::Output(fd), chunk_size) {}
+
+    explicit VectorWriter(std::ostream& stream, size_t chunk_size = DEFAULT_CHUNK_SIZE)
+        : VectorWriter(stream_detail::Output(stream), chunk_size) {}
+
+    VectorWriter(const VectorWriter&) = delete;
+    VectorWriter& operator=(const VectorWriter&) = delete;
+
+    ~VectorWriter() {
+        if (!finished_) {
+            try {
+                Finish();
+            } catch (...) {
+            }
+        }
+    }
+
+    void Write(const Type& item) {
+        Write(&item, 1);
+    }
+
+    template <typename Allocator>
+    void Write(const SimpleVector<Type, Allocator>& items) {
+        Write(items.begin(), items.GetSize());
+    }
+
+    void Write(const Type* items, size_t count) {
+        assert(!finished_);
+        if (buffered_ != 0) {
+            const size_t taken = std::min(count, chunk_size_ - buffered_);
+            std::copy(items, items + taken, buffer_.Get() + buffered_);
+            buffered_ += taken;
+            items += taken;
+            count -= taken;
+            if (buffered_ != chunk_size_) {
+                return;
+            }
+            FlushBuffer();
+        }
+        for (; count >= chunk_size_; items += chunk_size_, count -= chunk_size_) {
+            WriteChunk(items, chunk_size_);
+        }
+        std::copy(items, items + count, buffer_.Get());
+        buffered_ = count;
+    }
+
+    // Дописывает неполный блок и завершающий пустой блок
+    void Finish() {
+        if (finished_) {
+            return;
+        }
+        finished_ = true;
+        FlushBuffer();
+        WriteChunk(nullptr, 0);
+    }
+
+private:
+    VectorWriter(stream_detail::Output output, size_t chunk_size)
+        : output_(output), chunk_size_(std::clamp<size_t>(chunk_size, 1, MAX_CHUNK_SIZE)), buffer_(chunk_size_) {
+        using namespace stream_detail;
+        StreamHeader header = {};
+        std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+        header.version = VERSION;
+        header.endianness = serialization_detail::NativeEndianness();
+        header.element_size = sizeof(Type);
+        header.chunk_size = chunk_size_;
+        iovec buffers[1] = {{&header, sizeof(header)}};
+        output_.Write(buffers, 1);
+    }
+
+    void FlushBuffer() {
+        if (buffered_ != 0) {
+            WriteChunk(buffer_.Get(), buffered_);
+            buffered_ = 0;
+        }
+    }
+
+    void WriteChunk(const Type* items, size_t count) {
+        const size_t bytes = count * sizeof(Type);
+        stream_detail::ChunkHeader header = {count, stream_detail::Checksum(items, bytes)};
+        iovec buffers[2] = {{&header, sizeof(header)}, {const_cast<Type*>(items), bytes}};
+        output_.Write(buffers, count == 0 ? 1 : 2);
+    }
+
+    stream_detail::Output output_;
+    size_t chunk_size_;
+    ArrayPtr<Type> buffer_;
+    size_t buffered_ = 0;
+    bool finished_ = false;
+};
+
+// Режим чтения VectorReader
+enum class PrefetchMode {
+    // Блоки читаются в потоке вызывающего
+    SYNC,
+    // Следующий блок читается и проверяется фоновым потоком, пока вызывающий обрабатывает текущий
+    BACKGROUND,
+};
+
+// Читает поток, записанный VectorWriter, по блокам. Заголовок читается и проверяется
+// в конструкторе. В режиме BACKGROUND буферы блоков переиспользуются: вектор, переданный
+// в ReadChunk, отдаётся фоновому потоку под следующий блок.
+// Пока читатель жив, источник нельзя использовать из других мест.
+// Поток с длиной блока больше MAX_CHUNK_SIZE отвергается
+template <typename Type>
+class VectorReader {
+    static_assert(std::is_trivially_copyable_v<Type>, "VectorReader requires trivially copyable type");
+
+public:
+    static constexpr size_t MAX_CHUNK_SIZE = VectorWriter<Type>::MAX_CHUNK_SIZE;
+
+    // Фоновое чтение из канала или сокета прерывается деструктором, даже если данные не приходят
+    explicit VectorReader(int fd, PrefetchMode mode = PrefetchMode::BACKGROUND)
+        : VectorReader(stream_detail::Input(fd), mode) {}
+
+    // Фоновое чтение из std::istream прервать нельзя: деструктор ждёт, пока фоновый поток
+    // дочитает блок. Для источников, которые могут блокироваться бесконечно, используйте
+    // дескриптор или режим SYNC
+    explicit VectorReader(std::istream& stream, PrefetchMode mode = PrefetchMode::BACKGROUND)
+        : VectorReader(stream_detail::Input(stream), mode) {}
+
+    VectorReader(const VectorReader&) = delete;
+    VectorReader& operator=(const VectorReader&) = delete;
+
+    // Останавливает фоновый поток, прерывая ожидание данных из дескриптора
+    ~VectorReader() {
+        if (prefetcher_.joinable()) {
+            {
+                std::lock_guard lock(mutex_);
+                stop_ = true;
+            }
+            changed_.notify_all();
+            if (wake_[1] >= 0) {
+                const char signal = 0;
+                while (::write(wake_[1], &signal, 1) < 0 && errno == EINTR) {
+                }
+            }
+            prefetcher_.join();
+        }
+        CloseWakePipe();
+    }
+
+    // Длина блока, с которой поток был записан
+    size_t GetChunkSize() const noexcept {
+        return chunk_size_;
+    }
+
+    // Заменяет содержимое chunk следующим блоком. Возвращает false, когда блоки закончились.
+    // Выбрасывает std::runtime_error при несовпадении контрольной суммы или обрыве потока
+    bool ReadChunk(SimpleVector<Type>& chunk) {
+        if (done_) {
+            chunk.Clear();
+            return false;
+        }
+        if (!prefetcher_.joinable()) {
+            done_ = !ReadNext(chunk);
+            return !done_;
+        }
+        std::unique_lock lock(mutex_);
+        changed_.wait(lock, [this] {
+            return has_ready_;
+        });
+        has_ready_ = false;
+        done_ = ready_last_;
+        if (error_) {
+            std::rethrow_exception(error_);
+        }
+        chunk.swap(ready_);
+        lock.unlock();
+        changed_.notify_all();
+        return !done_;
+    }
+
+    // Читает все оставшиеся блоки в один вектор
+    SimpleVector<Type> ReadAll() {
+        SimpleVector<Type> result;
+        SimpleVector<Type> chunk;
+        while (ReadChunk(chunk)) {
+            const size_t offset = result.GetSize();
+            result.Resize(offset + chunk.GetSize());
+            std::copy(chunk.begin(), chunk.end(), result.begin() + offset);
+        }
+        return result;
+    }
+
+private:
+    VectorReader(stream_detail::Input input, PrefetchMode mode) : input_(input) {
+        using namespace stream_detail;
+        StreamHeader header;
+        input_.Read(&header, sizeof(header));
+        if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0) {
+            throw std::runtime_error("not a vector stream");
+        }
+        if (header.version != VERSION) {
+            throw std::runtime_error("unsupported vector stream version");
+        }
+        if (header.endianness != serialization_detail::NativeEndianness()) {
+            throw std::runtime_error("vector was serialized with different byte order");
+        }
+        if (header.element_size != sizeof(Type)) {
+            throw std::runtime_error("element size mismatch");
+        }
+        if (header.chunk_size == 0 || header.chunk_size > MAX_CHUNK_SIZE) {
+            throw std::runtime_error("invalid vector stream chunk size");
+        }
+        chunk_size_ = static_cast<size_t>(header.chunk_size);
+        if (mode == PrefetchMode::BACKGROUND) {
+            if (input_.IsDescriptor()) {
+                if (::pipe(wake_) != 0) {
+                    throw std::system_error(errno, std::generic_category(), "pipe");
+                }
+                input_.SetWakeFd(wake_[0]);
+            }
+            try {
+                prefetcher_ = std::thread([this] {
+                    Prefetch();
+                });
+            } catch (...) {
+                CloseWakePipe();
+                throw;
+            }
+        }
+    }
+
+    void CloseWakePipe() noexcept {
+        for (int& fd : wake_) {
+            if (fd >= 0) {
+                ::close(fd);
+                fd = -1;
+            }
+        }
+    }
+
+    // Читает и проверяет следующий блок. Возвращает false на завершающем пустом блоке
+    bool ReadNext(SimpleVector<Type>& chunk) {
+        stream_detail::ChunkHeader header;
+        input_.Read(&header, sizeof(header));
+        chunk.Clear();
+        if (header.count == 0) {
+            return false;
+        }
+        if (header.count > chunk_size_) {
+            throw std::runtime_error("vector stream chunk is longer than declared");
+        }
+        const size_t count = static_cast<size_t>(header.count);
+        chunk.Resize(count);
+        input_.Read(chunk.begin(), count * sizeof(Type));
+        if (stream_detail::Checksum(chunk.begin(), count * sizeof(Type)) != header.checksum) {
+            throw std::runtime_error("vector stream chunk checksum mismatch");
+        }
+        return true;
+    }
+
+    // Тело фонового потока: читает блок вперёд и ждёт, пока предыдущий заберут
+    void Prefetch() {
+        SimpleVector<Type> buffer;
+        bool last = false;
+        while (!last) {
+            std::exception_ptr error;
+            try {
+                last = !ReadNext(buffer);
+            } catch (...) {
+                error = std::current_exception();
+                last = true;
+            }
+            std::unique_lock lock(mutex_);
+            changed_.wait(lock, [this] {
+                return stop_ || !has_ready_;
+            });
+            if (stop_) {
+                return;
+            }
+            ready_.swap(buffer);
+            ready_last_ = last;
+            error_ = error;
+            has_ready_ = true;
+            lock.unlock();
+            changed_.notify_all();
+        }
+    }
+
+    stream_detail::Input input_;
+    size_t chunk_size_ = 0;
+    bool done_ = false;
+
+    std::mutex mutex_;
+    std::condition_variable changed_;
+    SimpleVector<Type> ready_;
+    bool has_ready_ = false;
+    bool ready_last_ = false;
+    bool stop_ = false;
+    std::exception_ptr error_;
+    int wake_[2] = {-1, -1};
+    std::thread prefetcher_;
+};